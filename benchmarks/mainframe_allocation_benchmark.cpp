@@ -0,0 +1,128 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+// Counts the column allocations made by groupby/aggregate, the joins and
+// series moves. Every series_vector allocates through the default
+// memory_resource, so installing a counting resource sees all of them.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "mainframe.hpp"
+
+using namespace mf;
+using namespace mf::placeholders;
+
+class counting_resource : public memory_resource
+{
+public:
+    size_t allocations = 0;
+    size_t bytes       = 0;
+
+    void
+    reset()
+    {
+        allocations = 0;
+        bytes       = 0;
+    }
+
+protected:
+    void*
+    do_allocate(size_t n, size_t alignment) override
+    {
+        ++allocations;
+        bytes += n;
+        return aligned_heap_resource()->allocate(n, alignment);
+    }
+
+    void
+    do_deallocate(void* p, size_t n, size_t alignment) override
+    {
+        aligned_heap_resource()->deallocate(p, n, alignment);
+    }
+
+    void*
+    do_reallocate(void* p, size_t old_n, size_t new_n, size_t alignment) override
+    {
+        ++allocations;
+        bytes += new_n;
+        return aligned_heap_resource()->reallocate(p, old_n, new_n, alignment);
+    }
+};
+
+template<typename Func>
+void
+run(const char* name, counting_resource& res, Func func)
+{
+    res.reset();
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto stop = std::chrono::steady_clock::now();
+    auto us   = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+    std::printf("%-24s %10zu allocations %14zu bytes %10lld us\n", name, res.allocations,
+        res.bytes, static_cast<long long>(us));
+}
+
+int
+main()
+{
+    counting_resource res;
+    set_default_resource(&res);
+
+    const int num_rows = 200000;
+    const int num_keys = 1000;
+
+    frame<int, double, int> left;
+    frame<int, double> right;
+    left.set_column_names("key", "value", "flag");
+    right.set_column_names("key", "weight");
+    for (int i = 0; i < num_rows; ++i) {
+        left.push_back(i % num_keys, i * 0.5, i % 3);
+    }
+    for (int i = 0; i < num_keys; ++i) {
+        right.push_back(i, i * 2.0);
+    }
+
+    run("groupby().aggregate()", res, [&] {
+        auto g   = left.groupby(_0);
+        auto out = g.aggregate(agg::sum(_1), agg::count());
+        (void)out;
+    });
+
+    run("innerjoin()", res, [&] {
+        auto out = innerjoin(left, _0, right, _0);
+        (void)out;
+    });
+
+    run("leftjoin()", res, [&] {
+        auto out = leftjoin(left, _0, right, _0);
+        (void)out;
+    });
+
+    run("empty series", res, [&] {
+        std::vector<series<double>> v;
+        v.reserve(100000);
+        for (int i = 0; i < 100000; ++i) {
+            v.emplace_back();
+        }
+        std::vector<series<double>> w;
+        w.reserve(v.size());
+        for (auto& s : v) {
+            w.push_back(std::move(s));
+        }
+    });
+
+    run("frame copy/move", res, [&] {
+        for (int i = 0; i < 10000; ++i) {
+            frame<int, double, int> f;
+            frame<int, double, int> g(std::move(f));
+            frame<int, double, int> h = g;
+            (void)h;
+        }
+    });
+
+    set_default_resource(nullptr);
+    return 0;
+}
@@ -0,0 +1,97 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+// Compares scan throughput over a large column allocated with ordinary
+// pages against huge_page_resource with each NUMA placement. mean() reads
+// the column in order; the gather reads it at random rows, which is where
+// the TLB misses of 4KiB pages show most. Pass the number of rows as the
+// first argument (default 32M, 256MiB of doubles).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "mainframe.hpp"
+
+using namespace mf;
+
+template<typename Func>
+double
+best_of(int reps, Func func)
+{
+    double best = 1e300;
+    for (int r = 0; r < reps; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        auto stop = std::chrono::steady_clock::now();
+        best      = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+void
+run(const char* name, memory_resource* res, size_t num_rows, const std::vector<uint32_t>& rows)
+{
+    series<double> s(res);
+    s.reserve(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        s.push_back(static_cast<double>(i % 1000));
+    }
+    const series<double>& cs = s;
+
+    volatile double sink = 0.0;
+    double scan          = best_of(5, [&] { sink = cs.mean(); });
+    double gather        = best_of(5, [&] {
+        const double* d = cs.data();
+        double sum      = 0.0;
+        for (uint32_t r : rows) {
+            sum += d[r];
+        }
+        sink = sum;
+    });
+    (void)sink;
+
+    double gib = static_cast<double>(num_rows * sizeof(double)) / (1 << 30);
+    std::printf("%-26s mean() %8.2f GiB/s   random gather %8.1f Mrows/s\n", name, gib / scan,
+        rows.size() / gather / 1e6);
+}
+
+int
+main(int argc, char** argv)
+{
+    size_t num_rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : size_t{ 32 } << 20;
+
+    std::vector<uint32_t> rows(size_t{ 1 } << 22);
+    std::mt19937 gen{ 42 };
+    std::uniform_int_distribution<uint32_t> dist(0, static_cast<uint32_t>(num_rows - 1));
+    for (uint32_t& r : rows) {
+        r = dist(gen);
+    }
+
+    huge_page_resource::options opts;
+    opts.pages = huge_pages::none;
+    huge_page_resource small_pages(opts);
+    run("4KiB pages", &small_pages, num_rows, rows);
+
+    opts.pages = huge_pages::transparent;
+    huge_page_resource thp(opts);
+    run("transparent huge pages", &thp, num_rows, rows);
+
+    opts.pages = huge_pages::hugetlb;
+    huge_page_resource hugetlb(opts);
+    run("hugetlb", &hugetlb, num_rows, rows);
+
+    opts.pages     = huge_pages::transparent;
+    opts.placement = numa_placement::local;
+    huge_page_resource local(opts);
+    run("huge pages, local node", &local, num_rows, rows);
+
+    opts.placement = numa_placement::interleave;
+    huge_page_resource interleave(opts);
+    run("huge pages, interleaved", &interleave, num_rows, rows);
+
+    return 0;
+}
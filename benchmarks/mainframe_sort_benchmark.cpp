@@ -0,0 +1,123 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+// Compares frame::argsort() and frame::sort(), which radix sort integer,
+// floating point and date keys, against the comparison sort they fall back
+// to for other key types. Keys are an int64 id, a double price and a date
+// packed with an int32 into one 64-bit key; a double and an int64 together
+// are too wide to pack, and are sorted on normalized sort_keys instead. The
+// last lines compare sorting with parallel{}, a thread per core, against
+// one thread. Pass the row counts to run as arguments (default 1M, 10M and
+// 100M; the last needs about 6GiB).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "mainframe.hpp"
+
+using namespace mf;
+using namespace mf::placeholders;
+
+using day_point = std::chrono::time_point<std::chrono::system_clock,
+    std::chrono::duration<int32_t, std::ratio<86400>>>;
+
+template<typename Func>
+double
+best_of(int reps, Func func)
+{
+    double best = 1e300;
+    for (int r = 0; r < reps; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        auto stop = std::chrono::steady_clock::now();
+        best      = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+// The comparison sort that argsort() falls back to
+template<typename... Ts>
+double
+time_comparison(size_t num_rows, const series<Ts>&... cols)
+{
+    return best_of(3, [&] {
+        std::vector<size_t> order(num_rows);
+        std::iota(order.begin(), order.end(), size_t{ 0 });
+        detail::index_compare<false, Ts...> cmp{ std::make_tuple(cols.data()...) };
+        std::stable_sort(order.begin(), order.end(), cmp);
+    });
+}
+
+void
+report(const char* name, size_t num_rows, double radix, double comparison)
+{
+    std::printf("%-24s keys  %8.1f Mrows/s   comparison %8.1f Mrows/s   %5.1fx\n", name,
+        num_rows / radix / 1e6, num_rows / comparison / 1e6, comparison / radix);
+}
+
+void
+run(size_t num_rows)
+{
+    frame<int64_t, double, day_point, int32_t> f;
+    f.reserve(num_rows);
+    std::mt19937_64 gen{ 42 };
+    std::uniform_int_distribution<int64_t> ids(-(int64_t{ 1 } << 40), int64_t{ 1 } << 40);
+    std::normal_distribution<double> prices(100.0, 25.0);
+    std::uniform_int_distribution<int32_t> dates(18000, 20000);
+    std::uniform_int_distribution<int32_t> venues(0, 63);
+    for (size_t i = 0; i < num_rows; ++i) {
+        f.push_back(ids(gen), prices(gen), day_point{ day_point::duration{ dates(gen) } },
+            venues(gen));
+    }
+    const auto& cf = f;
+
+    std::printf("%zu rows\n", num_rows);
+    report("int64 key", num_rows, best_of(3, [&] { cf.argsort(_0); }),
+        time_comparison(num_rows, cf.column(_0)));
+    report("double key", num_rows, best_of(3, [&] { cf.argsort(_1); }),
+        time_comparison(num_rows, cf.column(_1)));
+    report("date, int32 keys", num_rows, best_of(3, [&] { cf.argsort(_2, _3); }),
+        time_comparison(num_rows, cf.column(_2), cf.column(_3)));
+    report("double, int64 keys", num_rows, best_of(3, [&] { cf.argsort(_1, _0); }),
+        time_comparison(num_rows, cf.column(_1), cf.column(_0)));
+
+    double whole = best_of(3, [&] {
+        auto copy = f;
+        copy.sort(_0);
+    });
+    std::printf("%-24s %8.1f Mrows/s\n", "sort() by int64 key", num_rows / whole / 1e6);
+
+    parallel par;
+    double single = best_of(3, [&] { cf.argsort(_0); });
+    double multi  = best_of(3, [&] { cf.argsort(par, _0); });
+    std::printf("%-24s %u threads %8.1f Mrows/s   %5.1fx\n", "parallel int64 key", par.threads,
+        num_rows / multi / 1e6, single / multi);
+    double whole_par = best_of(3, [&] {
+        auto copy = f;
+        copy.sort(par, _0);
+    });
+    std::printf("%-24s %u threads %8.1f Mrows/s   %5.1fx\n\n", "parallel sort()", par.threads,
+        num_rows / whole_par / 1e6, whole / whole_par);
+}
+
+int
+main(int argc, char** argv)
+{
+    if (argc > 1) {
+        for (int a = 1; a < argc; ++a) {
+            run(std::strtoull(argv[a], nullptr, 10));
+        }
+    }
+    else {
+        run(size_t{ 1000000 });
+        run(size_t{ 10000000 });
+        run(size_t{ 100000000 });
+    }
+    return 0;
+}
@@ -5,17 +5,32 @@
 #ifndef INCLUDED_mainframe_h
 #define INCLUDED_mainframe_h
 
+#include "mainframe/arena_scope.hpp"
+#include "mainframe/categorical.hpp"
+#include "mainframe/chunked_series.hpp"
 #include "mainframe/columnindex.hpp"
+#include "mainframe/delta_series.hpp"
 #include "mainframe/expression.hpp"
 #include "mainframe/frame.hpp"
 #include "mainframe/impl/frame.hpp"
+#include "mainframe/frame_builder.hpp"
 #include "mainframe/frame_iterator.hpp"
 #include "mainframe/frame_row.hpp"
+#include "mainframe/frame_view.hpp"
 #include "mainframe/group.hpp"
 #include "mainframe/join.hpp"
+#include "mainframe/mapped_frame.hpp"
+#include "mainframe/mask.hpp"
+#include "mainframe/memory_resource.hpp"
 #include "mainframe/missing.hpp"
+#include "mainframe/nullable_series.hpp"
+#include "mainframe/parallel.hpp"
+#include "mainframe/rle_series.hpp"
 #include "mainframe/row_decl.hpp"
+#include "mainframe/row_frame.hpp"
 #include "mainframe/series.hpp"
 #include "mainframe/impl/series.hpp"
+#include "mainframe/sort_keys.hpp"
+#include "mainframe/string_series.hpp"
 
 #endif // INCLUDED_mainframe_h
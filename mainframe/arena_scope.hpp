@@ -0,0 +1,100 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_arena_scope_h
+#define INCLUDED_mainframe_arena_scope_h
+
+#include <utility>
+
+#include "mainframe/frame.hpp"
+#include "mainframe/memory_resource.hpp"
+#include "mainframe/series.hpp"
+
+namespace mf
+{
+
+///
+/// arena_scope class
+///
+/// While an arena_scope is alive, every series created on this thread
+/// without an explicit memory resource allocates from one @ref
+/// arena_resource, so the intermediate frames built by joins, groupby,
+/// rows() and the like cost a pointer bump instead of a malloc()/free()
+/// per column. All of it is released in one go when the scope ends.
+///
+///     frame<int, double> result;
+///     {
+///         arena_scope arena;
+///         auto joined  = innerjoin(orders, _0, prices, _0);
+///         auto grouped = joined.groupby(_0).aggregate(agg::sum(_2));
+///         result       = arena.promote(grouped.rows(_1 > 100.0));
+///     } // joined, grouped and their temporaries are freed here
+///
+/// Nothing allocated in the arena may outlive the scope, including copies
+/// made after it, since a series keeps allocating from the resource it was
+/// created with. By the same rule a series or frame created before the
+/// scope, even an empty one, never allocates from the arena. promote() copies a result out into the resource that was
+/// the default when the scope was entered - the enclosing arena_scope if
+/// there is one. Scopes only affect the thread that creates them.
+///
+class arena_scope
+{
+public:
+    explicit arena_scope(size_t chunk_size = arena_resource::default_chunk_size)
+        : m_arena(chunk_size)
+        , m_outer(get_default_resource())
+        , m_prev(detail::exchange_thread_resource(&m_arena))
+    {}
+
+    ~arena_scope() { detail::exchange_thread_resource(m_prev); }
+
+    arena_scope(const arena_scope&) = delete;
+    arena_scope&
+    operator=(const arena_scope&) = delete;
+
+    /// A copy of s whose buffer comes from outside this scope
+    template<typename T>
+    series<T>
+    promote(const series<T>& s) const
+    {
+        series<T> out(m_outer);
+        if (!s.empty()) {
+            out.reserve(s.size());
+            out.insert(out.cend(), s.cbegin(), s.cend());
+        }
+        out.set_name(s.name());
+        return out;
+    }
+
+    /// A copy of f whose columns come from outside this scope
+    template<typename... Ts>
+    frame<Ts...>
+    promote(const frame<Ts...>& f) const
+    {
+        return promote_impl(f, std::index_sequence_for<Ts...>{});
+    }
+
+    arena_resource&
+    resource() noexcept
+    {
+        return m_arena;
+    }
+
+private:
+    template<typename... Ts, size_t... Inds>
+    frame<Ts...>
+    promote_impl(const frame<Ts...>& f, std::index_sequence<Inds...>) const
+    {
+        return frame<Ts...>(promote(f.column(columnindex<Inds>{}))...);
+    }
+
+    arena_resource m_arena;
+    memory_resource* m_outer;
+    memory_resource* m_prev;
+};
+
+} // namespace mf
+
+
+#endif // INCLUDED_mainframe_arena_scope_h
@@ -0,0 +1,226 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_categorical_h
+#define INCLUDED_mainframe_categorical_h
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+#include "mainframe/detail/base.hpp"
+
+namespace mf
+{
+
+namespace detail
+{
+
+///
+/// The process-wide dictionary behind @ref categorical. Strings are interned
+/// once and never removed, so a code means the same string in every column
+/// and every frame. Interning takes a write lock only for strings that
+/// haven't been seen before, and looking a code up takes no lock at all, so
+/// sorting a categorical column costs about what sorting strings does.
+///
+class category_pool
+{
+public:
+    static category_pool&
+    instance();
+
+    int32_t
+    intern(std::string_view s);
+
+    const std::string&
+    lookup(int32_t code) const noexcept
+    {
+        // Whoever handed over the code interned it first, so its block has
+        // been published
+        auto i     = static_cast<uint64_t>(code) + 1;
+        unsigned b = 63 - clz64(i);
+        return m_blocks[b].load(std::memory_order_acquire)[i - (uint64_t{ 1 } << b)];
+    }
+
+    size_t
+    size() const noexcept
+    {
+        return m_size.load(std::memory_order_acquire);
+    }
+
+private:
+    category_pool();
+    ~category_pool();
+
+    // Strings by code. Block b holds codes [2^b - 1, 2^(b+1) - 1), so
+    // blocks never move once allocated and readers need no lock.
+    std::array<std::atomic<std::string*>, 32> m_blocks{};
+    std::atomic<size_t> m_size{ 0 };
+
+    std::shared_mutex m_mutex;
+    std::unordered_map<std::string_view, int32_t> m_codes;
+};
+
+template<typename S>
+using if_string_like =
+    std::enable_if_t<std::is_convertible<const S&, std::string_view>::value, bool>;
+
+} // namespace detail
+
+///
+/// categorical class
+///
+/// A dictionary-encoded string for low-cardinality columns such as symbols,
+/// venues or accounts. Each element is a 4-byte code into a shared
+/// dictionary instead of a 32-byte std::string, and equality and hashing
+/// compare codes, so build_index(), joins and groupby on a categorical
+/// column never touch the characters. Ordering is by the strings, so
+/// sort() gives the same order as it would for std::string.
+///
+///     frame<categorical, double> trades;
+///     trades.push_back("AAPL", 187.2);
+///     trades.push_back("MSFT", 402.1);
+///     auto by_symbol = trades.groupby(_0).aggregate(agg::mean(_1));
+///
+/// The dictionary is global, so codes from different frames already agree
+/// and concatenating, hcat'ing or joining categorical columns needs no
+/// re-encoding. A default-constructed categorical is the empty string.
+///
+class categorical
+{
+public:
+    categorical() noexcept = default;
+
+    categorical(std::string_view s)
+        : m_code(detail::category_pool::instance().intern(s))
+    {}
+
+    categorical(const std::string& s)
+        : categorical(std::string_view{ s })
+    {}
+
+    categorical(const char* s)
+        : categorical(std::string_view{ s })
+    {}
+
+    int32_t
+    code() const noexcept
+    {
+        return m_code;
+    }
+
+    const std::string&
+    str() const
+    {
+        return detail::category_pool::instance().lookup(m_code);
+    }
+
+    /// The number of distinct strings interned so far
+    static size_t
+    num_categories()
+    {
+        return detail::category_pool::instance().size();
+    }
+
+    bool
+    operator==(const categorical& other) const noexcept
+    {
+        return m_code == other.m_code;
+    }
+
+    bool
+    operator!=(const categorical& other) const noexcept
+    {
+        return m_code != other.m_code;
+    }
+
+    bool
+    operator<(const categorical& other) const
+    {
+        return m_code != other.m_code && str() < other.str();
+    }
+
+    bool
+    operator>(const categorical& other) const
+    {
+        return other < *this;
+    }
+
+    bool
+    operator<=(const categorical& other) const
+    {
+        return !(other < *this);
+    }
+
+    bool
+    operator>=(const categorical& other) const
+    {
+        return !(*this < other);
+    }
+
+    // Comparing with a string doesn't intern it. These are hidden friends so
+    // that they don't make other string comparisons ambiguous.
+    template<typename S, detail::if_string_like<S> = true>
+    friend bool
+    operator==(const categorical& c, const S& s)
+    {
+        return std::string_view{ c.str() } == std::string_view{ s };
+    }
+
+    template<typename S, detail::if_string_like<S> = true>
+    friend bool
+    operator==(const S& s, const categorical& c)
+    {
+        return std::string_view{ c.str() } == std::string_view{ s };
+    }
+
+    template<typename S, detail::if_string_like<S> = true>
+    friend bool
+    operator!=(const categorical& c, const S& s)
+    {
+        return !(c == s);
+    }
+
+    template<typename S, detail::if_string_like<S> = true>
+    friend bool
+    operator!=(const S& s, const categorical& c)
+    {
+        return !(c == s);
+    }
+
+private:
+    int32_t m_code = 0;
+};
+
+inline std::ostream&
+operator<<(std::ostream& o, const categorical& c)
+{
+    o << c.str();
+    return o;
+}
+
+} // namespace mf
+
+namespace std
+{
+template<>
+struct hash<mf::categorical>
+{
+    size_t
+    operator()(const mf::categorical& c) const noexcept
+    {
+        return std::hash<int32_t>{}(c.code());
+    }
+};
+} // namespace std
+
+
+#endif // INCLUDED_mainframe_categorical_h
@@ -0,0 +1,411 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_chunked_series_h
+#define INCLUDED_mainframe_chunked_series_h
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mainframe/detail/series_vector.hpp"
+#include "mainframe/detail/simd.hpp"
+#include "mainframe/series.hpp"
+
+namespace mf
+{
+
+///
+/// chunked_series class
+///
+/// A column stored as a list of fixed-capacity chunks instead of one
+/// contiguous array. Each chunk is reference counted on its own, so copying
+/// a chunked_series only copies chunk pointers and writing to one element
+/// of a shared column copies just the chunk holding it - not the whole
+/// column as @ref series::unref() does. Appending fills the last chunk and
+/// then starts a new one, so existing elements are never reallocated or
+/// moved, and concatenation splices the other column's chunks in without
+/// copying any elements.
+///
+///     chunked_series<double> prices;
+///     for (double p : feed) {
+///         prices.push_back(p);
+///     }
+///     chunked_series<double> snapshot = prices; // shares every chunk
+///     prices.at(42) = 0.0;                      // copies one chunk
+///
+/// chunked_series is one of several column containers that store their
+/// elements in some other layout than one contiguous array, along with
+/// nullable_series, string_series, rle_series and delta_series. None of
+/// them can be a @ref frame column, since a frame keeps every column in a
+/// series<T>; each has a conversion to a series, like to_series() here, to
+/// get a frame column out of it.
+///
+template<typename T>
+class chunked_series
+{
+    using chunk     = detail::series_vector<T>;
+    using chunk_ptr = std::shared_ptr<chunk>;
+
+public:
+    /// Elements per chunk unless another size is given. Large enough that
+    /// per-chunk bookkeeping is negligible, small enough that copying a
+    /// chunk on write is cheap.
+    static constexpr size_t default_chunk_size = std::max<size_t>(1024, (512 * 1024) / sizeof(T));
+
+    using value_type      = T;
+    using size_type       = size_t;
+    using reference       = T&;
+    using const_reference = const T&;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = T;
+        using pointer           = const T*;
+        using reference         = const T&;
+
+        const_iterator() = default;
+        const_iterator(const chunked_series* s, size_t chunk, size_t pos)
+            : m_series(s)
+            , m_chunk(chunk)
+            , m_pos(pos)
+        {}
+
+        reference
+        operator*() const
+        {
+            return (*m_series->m_chunks[m_chunk])[m_pos];
+        }
+
+        pointer
+        operator->() const
+        {
+            return &**this;
+        }
+
+        const_iterator&
+        operator++()
+        {
+            if (++m_pos == m_series->m_chunks[m_chunk]->size()) {
+                ++m_chunk;
+                m_pos = 0;
+            }
+            return *this;
+        }
+
+        const_iterator
+        operator++(int)
+        {
+            const_iterator out{ *this };
+            ++*this;
+            return out;
+        }
+
+        bool
+        operator==(const const_iterator& other) const
+        {
+            return m_chunk == other.m_chunk && m_pos == other.m_pos;
+        }
+
+        bool
+        operator!=(const const_iterator& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        const chunked_series* m_series = nullptr;
+        size_t m_chunk                 = 0;
+        size_t m_pos                   = 0;
+    };
+
+    chunked_series()
+        : m_chunk_size(default_chunk_size)
+    {}
+
+    explicit chunked_series(size_t chunk_size)
+        : m_chunk_size(std::max<size_t>(chunk_size, 1))
+    {}
+
+    explicit chunked_series(const series<T>& s, size_t chunk_size = default_chunk_size)
+        : m_name(s.name())
+        , m_chunk_size(std::max<size_t>(chunk_size, 1))
+    {
+        append(s.cbegin(), s.cend());
+    }
+
+    /// Append one element. Never moves existing elements
+    void
+    push_back(const T& value)
+    {
+        writable_tail().push_back(value);
+        ++m_ends.back();
+    }
+
+    void
+    push_back(T&& value)
+    {
+        writable_tail().push_back(std::move(value));
+        ++m_ends.back();
+    }
+
+    template<typename... Args>
+    reference
+    emplace_back(Args&&... args)
+    {
+        auto& r = writable_tail().emplace_back(std::forward<Args>(args)...);
+        ++m_ends.back();
+        return r;
+    }
+
+    /// Append [first, last) chunk by chunk
+    template<typename InputIt>
+    void
+    append(InputIt first, InputIt last)
+    {
+        while (first != last) {
+            chunk& tail = writable_tail();
+            size_t room = m_chunk_size - tail.size();
+            size_t n    = 0;
+            for (; n < room && first != last; ++n, ++first) {
+                tail.push_back(*first);
+            }
+            m_ends.back() += n;
+        }
+    }
+
+    /// Splice other's chunks onto the end of this column. No elements are
+    /// copied - the chunks are shared until one side writes to them. other
+    /// may be this column.
+    void
+    append(const chunked_series& other)
+    {
+        // other may be *this, so its chunk count is read before it grows
+        size_t base = size();
+        size_t n    = other.m_chunks.size();
+        m_chunks.reserve(m_chunks.size() + n);
+        m_ends.reserve(m_ends.size() + n);
+        for (size_t i = 0; i < n; ++i) {
+            m_chunks.push_back(other.m_chunks[i]);
+            m_ends.push_back(base + other.m_ends[i]);
+        }
+    }
+
+    chunked_series
+    operator+(const chunked_series& other) const
+    {
+        chunked_series out{ *this };
+        out.append(other);
+        return out;
+    }
+
+    reference
+    at(size_t n)
+    {
+        check_range(n);
+        size_t c = chunk_index(n);
+        return writable_chunk(c)[n - chunk_begin(c)];
+    }
+
+    const_reference
+    at(size_t n) const
+    {
+        check_range(n);
+        return (*this)[n];
+    }
+
+    const_reference
+    operator[](size_t n) const
+    {
+        size_t c = chunk_index(n);
+        return (*m_chunks[c])[n - chunk_begin(c)];
+    }
+
+    const_iterator
+    begin() const
+    {
+        return const_iterator{ this, 0, 0 };
+    }
+
+    const_iterator
+    end() const
+    {
+        return const_iterator{ this, m_chunks.size(), 0 };
+    }
+
+    const_iterator
+    cbegin() const
+    {
+        return begin();
+    }
+
+    const_iterator
+    cend() const
+    {
+        return end();
+    }
+
+    void
+    clear()
+    {
+        m_chunks.clear();
+        m_ends.clear();
+    }
+
+    bool
+    empty() const
+    {
+        return m_ends.empty();
+    }
+
+    size_t
+    size() const
+    {
+        return m_ends.empty() ? 0 : m_ends.back();
+    }
+
+    size_t
+    chunk_size() const
+    {
+        return m_chunk_size;
+    }
+
+    size_t
+    num_chunks() const
+    {
+        return m_chunks.size();
+    }
+
+    /// The contiguous elements of chunk c, for scanning a chunk at a time
+    const T*
+    chunk_data(size_t c) const
+    {
+        return m_chunks.at(c)->data();
+    }
+
+    size_t
+    chunk_length(size_t c) const
+    {
+        return m_chunks.at(c)->size();
+    }
+
+    /// How many chunked_series share chunk c
+    size_t
+    chunk_use_count(size_t c) const
+    {
+        return m_chunks.at(c).use_count();
+    }
+
+    double
+    mean() const
+    {
+        double sum = 0.0;
+        for (auto& c : m_chunks) {
+            sum += detail::mean(c->data(), c->size()) * c->size();
+        }
+        return sum / size();
+    }
+
+    const std::string&
+    name() const
+    {
+        return m_name;
+    }
+
+    void
+    set_name(const std::string& name)
+    {
+        m_name = name;
+    }
+
+    /// Copy into a contiguous series
+    series<T>
+    to_series() const
+    {
+        series<T> out;
+        out.reserve(size());
+        for (auto& c : m_chunks) {
+            out.insert(out.cend(), c->cbegin(), c->cend());
+        }
+        out.set_name(m_name);
+        return out;
+    }
+
+    bool
+    operator==(const chunked_series& other) const
+    {
+        return m_name == other.m_name && size() == other.size() &&
+            std::equal(begin(), end(), other.begin());
+    }
+
+    bool
+    operator!=(const chunked_series& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    void
+    check_range(size_t n) const
+    {
+        if (n >= size()) {
+            throw std::out_of_range{ "size() is " + std::to_string(size()) + ", pos is " +
+                std::to_string(n) };
+        }
+    }
+
+    size_t
+    chunk_index(size_t n) const
+    {
+        return std::upper_bound(m_ends.begin(), m_ends.end(), n) - m_ends.begin();
+    }
+
+    size_t
+    chunk_begin(size_t c) const
+    {
+        return c == 0 ? 0 : m_ends[c - 1];
+    }
+
+    chunk&
+    writable_chunk(size_t c)
+    {
+        chunk_ptr& p = m_chunks[c];
+        if (p.use_count() > 1) {
+            auto n = std::make_shared<chunk>(p->get_memory_resource());
+            n->reserve(std::max(m_chunk_size, p->size()));
+            n->insert(n->cend(), p->cbegin(), p->cend());
+            p = std::move(n);
+        }
+        return *p;
+    }
+
+    // The chunk to append to, starting a new one when the last is full
+    chunk&
+    writable_tail()
+    {
+        if (m_chunks.empty() || m_chunks.back()->size() >= m_chunk_size) {
+            auto n = std::make_shared<chunk>();
+            n->reserve(m_chunk_size);
+            m_chunks.push_back(std::move(n));
+            m_ends.push_back(size());
+        }
+        return writable_chunk(m_chunks.size() - 1);
+    }
+
+    std::string m_name;
+    size_t m_chunk_size;
+    std::vector<chunk_ptr> m_chunks;
+    std::vector<size_t> m_ends;
+};
+
+} // namespace mf
+
+
+#endif // INCLUDED_mainframe_chunked_series_h
@@ -0,0 +1,459 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_delta_series_h
+#define INCLUDED_mainframe_delta_series_h
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "mainframe/mask.hpp"
+#include "mainframe/series.hpp"
+
+namespace mf
+{
+
+///
+/// delta_traits
+///
+/// How @ref delta_series maps a value to and from a 64-bit integer.
+/// Integers, std::chrono durations and std::chrono time points are
+/// supported; specialize this for other types with an integer
+/// representation, e.g. a calendar date as days since the epoch.
+///
+template<typename T, typename = void>
+struct delta_traits;
+
+template<typename T>
+struct delta_traits<T, std::enable_if_t<std::is_integral<T>::value>>
+{
+    static int64_t
+    to_int(const T& t)
+    {
+        return static_cast<int64_t>(t);
+    }
+
+    static T
+    from_int(int64_t i)
+    {
+        return static_cast<T>(i);
+    }
+};
+
+template<typename Rep, typename Period>
+struct delta_traits<std::chrono::duration<Rep, Period>>
+{
+    using duration = std::chrono::duration<Rep, Period>;
+
+    static int64_t
+    to_int(const duration& d)
+    {
+        return static_cast<int64_t>(d.count());
+    }
+
+    static duration
+    from_int(int64_t i)
+    {
+        return duration{ static_cast<Rep>(i) };
+    }
+};
+
+template<typename Clock, typename Duration>
+struct delta_traits<std::chrono::time_point<Clock, Duration>>
+{
+    using time_point = std::chrono::time_point<Clock, Duration>;
+
+    static int64_t
+    to_int(const time_point& t)
+    {
+        return delta_traits<Duration>::to_int(t.time_since_epoch());
+    }
+
+    static time_point
+    from_int(int64_t i)
+    {
+        return time_point{ delta_traits<Duration>::from_int(i) };
+    }
+};
+
+///
+/// delta_series class
+///
+/// A frame-of-reference encoded column for integer-like values such as
+/// timestamps, sequence numbers and sorted keys. Values are split into
+/// blocks of 128; each block stores its minimum as a reference and every
+/// element as its delta from that reference, bit-packed at just the width
+/// the block's range needs. A block of per-second timestamps needs 7 bits
+/// per element instead of 64.
+///
+///     delta_series<std::chrono::sys_seconds> ts;
+///     for (auto& t : feed) {
+///         ts.push_back(t);
+///     }
+///     auto [first, last] = ts.minmax();   // no decoding
+///     mask window = ts.between(t0, t1);   // decodes only edge blocks
+///
+/// Elements are decoded on access, so operator[] returns by value. A
+/// delta_series isn't a frame column, but the mask between() returns
+/// selects rows of a frame it runs alongside with frame::filter().
+///
+template<typename T>
+class delta_series
+{
+    using traits = delta_traits<T>;
+
+    static constexpr size_t block_size = 128;
+    static constexpr size_t word_bits  = 64;
+
+    struct block
+    {
+        int64_t base;
+        int64_t max;
+        size_t word_offset;
+        uint32_t width;
+    };
+
+public:
+    using value_type = T;
+    using size_type  = size_t;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = T;
+        using pointer           = void;
+        using reference         = T;
+
+        const_iterator() = default;
+        const_iterator(const delta_series* s, size_t pos)
+            : m_series(s)
+            , m_pos(pos)
+        {}
+
+        T
+        operator*() const
+        {
+            return (*m_series)[m_pos];
+        }
+
+        const_iterator&
+        operator++()
+        {
+            ++m_pos;
+            return *this;
+        }
+
+        const_iterator
+        operator++(int)
+        {
+            const_iterator out{ *this };
+            ++m_pos;
+            return out;
+        }
+
+        bool
+        operator==(const const_iterator& other) const
+        {
+            return m_pos == other.m_pos;
+        }
+
+        bool
+        operator!=(const const_iterator& other) const
+        {
+            return m_pos != other.m_pos;
+        }
+
+    private:
+        const delta_series* m_series = nullptr;
+        size_t m_pos                 = 0;
+    };
+
+    delta_series() = default;
+
+    explicit delta_series(const series<T>& s)
+        : m_name(s.name())
+    {
+        for (const T& t : s) {
+            push_back(t);
+        }
+    }
+
+    delta_series(std::initializer_list<T> init)
+    {
+        for (const T& t : init) {
+            push_back(t);
+        }
+    }
+
+    T
+    at(size_t n) const
+    {
+        if (n >= size()) {
+            throw std::out_of_range{ "size() is " + std::to_string(size()) + ", pos is " +
+                std::to_string(n) };
+        }
+        return (*this)[n];
+    }
+
+    const_iterator
+    begin() const
+    {
+        return const_iterator{ this, 0 };
+    }
+
+    const_iterator
+    end() const
+    {
+        return const_iterator{ this, size() };
+    }
+
+    const_iterator
+    cbegin() const
+    {
+        return begin();
+    }
+
+    const_iterator
+    cend() const
+    {
+        return end();
+    }
+
+    /// A mask with the bits set for elements in [lo, hi]. Blocks whose
+    /// whole range falls inside or outside [lo, hi] are filled without
+    /// decoding them.
+    mask
+    between(const T& lo, const T& hi) const
+    {
+        int64_t ilo = traits::to_int(lo);
+        int64_t ihi = traits::to_int(hi);
+        mask out;
+        out.reserve(size());
+        for (size_t b = 0; b < m_blocks.size(); ++b) {
+            const block& blk = m_blocks[b];
+            if (ilo <= blk.base && blk.max <= ihi) {
+                out.append(block_size, true);
+            }
+            else if (blk.max < ilo || ihi < blk.base) {
+                out.append(block_size, false);
+            }
+            else {
+                for (size_t j = 0; j < block_size; ++j) {
+                    int64_t v = decode(blk, j);
+                    out.push_back(ilo <= v && v <= ihi);
+                }
+            }
+        }
+        for (int64_t v : m_tail) {
+            out.push_back(ilo <= v && v <= ihi);
+        }
+        return out;
+    }
+
+    void
+    clear()
+    {
+        m_blocks.clear();
+        m_bits.clear();
+        m_tail.clear();
+    }
+
+    bool
+    empty() const
+    {
+        return size() == 0;
+    }
+
+    /// Bytes used by the encoded values and block headers
+    size_t
+    encoded_bytes() const
+    {
+        return m_bits.size() * sizeof(uint64_t) + m_blocks.size() * sizeof(block) +
+            m_tail.size() * sizeof(int64_t);
+    }
+
+    double
+    mean() const
+    {
+        double sum = 0.0;
+        for (const block& blk : m_blocks) {
+            // 128 deltas of up to 57 bits can't overflow the integer sum
+            double deltas = 0.0;
+            if (blk.width <= 57) {
+                uint64_t idelta = 0;
+                for (size_t j = 0; j < block_size; ++j) {
+                    idelta += delta(blk, j);
+                }
+                deltas = static_cast<double>(idelta);
+            }
+            else {
+                for (size_t j = 0; j < block_size; ++j) {
+                    deltas += static_cast<double>(delta(blk, j));
+                }
+            }
+            sum += static_cast<double>(blk.base) * block_size + deltas;
+        }
+        for (int64_t v : m_tail) {
+            sum += static_cast<double>(v);
+        }
+        return sum / size();
+    }
+
+    /// The minimum and maximum value, read from the block headers without
+    /// decoding any elements. Throws std::out_of_range if the column is
+    /// empty.
+    std::pair<T, T>
+    minmax() const
+    {
+        if (empty()) {
+            throw std::out_of_range{ "delta_series is empty" };
+        }
+        int64_t mn = std::numeric_limits<int64_t>::max();
+        int64_t mx = std::numeric_limits<int64_t>::min();
+        for (const block& blk : m_blocks) {
+            mn = std::min(mn, blk.base);
+            mx = std::max(mx, blk.max);
+        }
+        for (int64_t v : m_tail) {
+            mn = std::min(mn, v);
+            mx = std::max(mx, v);
+        }
+        return { traits::from_int(mn), traits::from_int(mx) };
+    }
+
+    const std::string&
+    name() const
+    {
+        return m_name;
+    }
+
+    T
+    operator[](size_t n) const
+    {
+        size_t b = n / block_size;
+        if (b < m_blocks.size()) {
+            return traits::from_int(decode(m_blocks[b], n % block_size));
+        }
+        return traits::from_int(m_tail[n - m_blocks.size() * block_size]);
+    }
+
+    bool
+    operator==(const delta_series& other) const
+    {
+        return m_name == other.m_name && size() == other.size() &&
+            std::equal(begin(), end(), other.begin());
+    }
+
+    bool
+    operator!=(const delta_series& other) const
+    {
+        return !(*this == other);
+    }
+
+    void
+    push_back(const T& value)
+    {
+        m_tail.push_back(traits::to_int(value));
+        if (m_tail.size() == block_size) {
+            pack_tail();
+        }
+    }
+
+    void
+    set_name(const std::string& name)
+    {
+        m_name = name;
+    }
+
+    size_t
+    size() const
+    {
+        return m_blocks.size() * block_size + m_tail.size();
+    }
+
+    series<T>
+    to_series() const
+    {
+        series<T> out;
+        out.reserve(size());
+        for (size_t i = 0; i < size(); ++i) {
+            out.push_back((*this)[i]);
+        }
+        out.set_name(m_name);
+        return out;
+    }
+
+private:
+    int64_t
+    decode(const block& blk, size_t j) const
+    {
+        return static_cast<int64_t>(static_cast<uint64_t>(blk.base) + delta(blk, j));
+    }
+
+    uint64_t
+    delta(const block& blk, size_t j) const
+    {
+        if (blk.width == 0) {
+            return 0;
+        }
+        size_t bit    = j * blk.width;
+        size_t word   = blk.word_offset + bit / word_bits;
+        size_t offset = bit % word_bits;
+        uint64_t d    = m_bits[word] >> offset;
+        if (offset + blk.width > word_bits) {
+            d |= m_bits[word + 1] << (word_bits - offset);
+        }
+        if (blk.width < word_bits) {
+            d &= (uint64_t{ 1 } << blk.width) - 1;
+        }
+        return d;
+    }
+
+    // Encode the 128 pending values as a new block
+    void
+    pack_tail()
+    {
+        auto [mn, mx] = std::minmax_element(m_tail.begin(), m_tail.end());
+        block blk;
+        blk.base        = *mn;
+        blk.max         = *mx;
+        blk.word_offset = m_bits.size();
+        uint64_t range  = static_cast<uint64_t>(blk.max) - static_cast<uint64_t>(blk.base);
+        blk.width       = range == 0 ? 0 : static_cast<uint32_t>(word_bits - detail::clz64(range));
+
+        m_bits.resize(m_bits.size() + (block_size * blk.width + word_bits - 1) / word_bits, 0);
+        for (size_t j = 0; j < block_size && blk.width != 0; ++j) {
+            uint64_t d    = static_cast<uint64_t>(m_tail[j]) - static_cast<uint64_t>(blk.base);
+            size_t bit    = j * blk.width;
+            size_t word   = blk.word_offset + bit / word_bits;
+            size_t offset = bit % word_bits;
+            m_bits[word] |= d << offset;
+            if (offset + blk.width > word_bits) {
+                m_bits[word + 1] |= d >> (word_bits - offset);
+            }
+        }
+        m_blocks.push_back(blk);
+        m_tail.clear();
+    }
+
+    std::string m_name;
+    std::vector<block> m_blocks;
+    std::vector<uint64_t> m_bits;
+    std::vector<int64_t> m_tail;
+};
+
+} // namespace mf
+
+
+#endif // INCLUDED_mainframe_delta_series_h
@@ -5,15 +5,24 @@
 #ifndef INCLUDED_mainframe_detail_base_h
 #define INCLUDED_mainframe_detail_base_h
 
+#include <cstdint>
 #include <ostream>
+#include <string>
 #include <variant>
 #include <vector>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace mf
 {
 template<typename T>
 class mi;
 
+template<typename T>
+class smi;
+
 namespace detail
 {
 
@@ -47,6 +56,19 @@ stringify(std::ostream& o, const mi<T>& t, bool)
     }
 }
 
+template<typename T>
+std::ostream&
+stringify(std::ostream& o, const smi<T>& t, bool)
+{
+    if (!t.has_value()) {
+        o << "missing";
+        return o;
+    }
+    else {
+        return stringify(o, *t, true);
+    }
+}
+
 template<typename T>
 std::ostream&
 stringify(std::ostream& o, const T&, int)
@@ -55,6 +77,67 @@ stringify(std::ostream& o, const T&, int)
     return o;
 }
 
+// Heap memory an element points to, beyond its own sizeof()
+template<typename T>
+size_t
+heap_bytes(const T&)
+{
+    return 0;
+}
+
+inline size_t
+heap_bytes(const std::string& s)
+{
+    // Short strings live inside the std::string object itself
+    static const size_t sso_capacity = std::string{}.capacity();
+    return s.capacity() > sso_capacity ? s.capacity() + 1 : 0;
+}
+
+template<typename T>
+size_t
+heap_bytes(const mi<T>& t)
+{
+    return t.has_value() ? heap_bytes(*t) : 0;
+}
+
+// Bit counts of a 64-bit word. MSVC has no __builtin_popcountll() and
+// friends, so it uses its own intrinsics. ctz64() and clz64() need w != 0.
+inline unsigned
+popcount64(uint64_t w) noexcept
+{
+#if defined(_MSC_VER)
+    return static_cast<unsigned>(__popcnt64(w));
+#else
+    return static_cast<unsigned>(__builtin_popcountll(w));
+#endif
+}
+
+// The number of trailing zero bits
+inline unsigned
+ctz64(uint64_t w) noexcept
+{
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward64(&i, w);
+    return static_cast<unsigned>(i);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(w));
+#endif
+}
+
+// The number of leading zero bits
+inline unsigned
+clz64(uint64_t w) noexcept
+{
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanReverse64(&i, w);
+    return 63 - static_cast<unsigned>(i);
+#else
+    return static_cast<unsigned>(__builtin_clzll(w));
+#endif
+}
+
 template<typename T, typename Vt>
 struct prepend_variant;
 
@@ -138,6 +221,10 @@ template<typename T>
 struct is_missing<mi<T>> : std::true_type
 {};
 
+template<typename T>
+struct is_missing<smi<T>> : std::true_type
+{};
+
 template<typename T>
 struct ensure_missing
 {
@@ -150,6 +237,12 @@ struct ensure_missing<mi<T>>
     using type = mi<T>;
 };
 
+template<typename T>
+struct ensure_missing<smi<T>>
+{
+    using type = smi<T>;
+};
+
 template<typename T>
 struct unwrap_missing
 {
@@ -178,6 +271,17 @@ struct unwrap_missing<mi<T>>
     }
 };
 
+template<typename T>
+struct unwrap_missing<smi<T>>
+{
+    using type = T;
+    static T
+    unwrap(const smi<T>& t)
+    {
+        return t.has_value() ? *t : T{};
+    }
+};
+
 template<typename T, typename Tpl>
 struct prepend;
 
@@ -0,0 +1,70 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+#include "mainframe/categorical.hpp"
+
+namespace mf::detail
+{
+
+category_pool::category_pool()
+{
+    // code 0 is the empty string, so default-constructed categoricals need
+    // no lookup
+    intern(std::string_view{});
+}
+
+category_pool::~category_pool()
+{
+    for (auto& block : m_blocks) {
+        delete[] block.load(std::memory_order_relaxed);
+    }
+}
+
+category_pool&
+category_pool::instance()
+{
+    static category_pool pool;
+    return pool;
+}
+
+int32_t
+category_pool::intern(std::string_view s)
+{
+    {
+        std::shared_lock lock{ m_mutex };
+        auto it = m_codes.find(s);
+        if (it != m_codes.end()) {
+            return it->second;
+        }
+    }
+
+    std::unique_lock lock{ m_mutex };
+    auto it = m_codes.find(s);
+    if (it != m_codes.end()) {
+        return it->second;
+    }
+    size_t n = m_size.load(std::memory_order_relaxed);
+    if (n > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+        throw std::length_error{ "too many categories" };
+    }
+    auto code          = static_cast<int32_t>(n);
+    uint64_t i         = n + 1;
+    unsigned b         = 63 - clz64(i);
+    std::string* block = m_blocks[b].load(std::memory_order_relaxed);
+    if (block == nullptr) {
+        block = new std::string[size_t{ 1 } << b];
+        m_blocks[b].store(block, std::memory_order_release);
+    }
+    std::string& str = block[i - (uint64_t{ 1 } << b)];
+    str.assign(s.data(), s.size());
+    m_codes.emplace(str, code);
+    m_size.store(n + 1, std::memory_order_release);
+    return code;
+}
+
+} // namespace mf::detail
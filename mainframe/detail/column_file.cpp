@@ -0,0 +1,278 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAINFRAME_HAS_MMAP 1
+#endif
+
+#include "mainframe/detail/column_file.hpp"
+#include "mainframe/memory_resource.hpp"
+
+namespace mf::detail
+{
+
+namespace
+{
+
+constexpr char column_file_magic[8] = { 'M', 'F', 'C', 'O', 'L', 'S', '\0', '\1' };
+
+uint64_t
+align_up(uint64_t n)
+{
+    return (n + column_alignment - 1) / column_alignment * column_alignment;
+}
+
+void
+bad_file(const std::string& source, const std::string& what)
+{
+    throw std::runtime_error{ source + " is not a valid column file: " + what };
+}
+
+} // namespace
+
+column_layout
+layout_columns(const std::vector<column_desc>& cols, size_t num_rows)
+{
+    column_layout out;
+    uint64_t names_offset =
+        sizeof(column_file_header) + cols.size() * sizeof(column_file_entry);
+    uint64_t names_size = 0;
+    for (const column_desc& c : cols) {
+        names_size += c.name.size();
+    }
+    out.header.resize(names_offset + names_size);
+
+    column_file_header hdr;
+    std::memcpy(hdr.magic, column_file_magic, sizeof(hdr.magic));
+    hdr.num_columns = cols.size();
+    hdr.num_rows    = num_rows;
+    std::memcpy(out.header.data(), &hdr, sizeof(hdr));
+
+    uint64_t name_offset = names_offset;
+    uint64_t data_offset = align_up(out.header.size());
+    for (size_t i = 0; i < cols.size(); ++i) {
+        column_file_entry entry;
+        entry.elem_size   = cols[i].elem_size;
+        entry.data_offset = data_offset;
+        entry.name_offset = name_offset;
+        entry.name_size   = cols[i].name.size();
+        std::memcpy(out.header.data() + sizeof(hdr) + i * sizeof(entry), &entry, sizeof(entry));
+        std::memcpy(out.header.data() + name_offset, cols[i].name.data(), cols[i].name.size());
+
+        out.data_offsets.push_back(data_offset);
+        name_offset += cols[i].name.size();
+        data_offset = align_up(data_offset + num_rows * cols[i].elem_size);
+    }
+    out.total_size = data_offset;
+    return out;
+}
+
+void
+copy_columns(char* dest, const column_layout& layout, const std::vector<column_desc>& cols,
+    size_t num_rows)
+{
+    std::memset(dest, 0, layout.total_size);
+    std::memcpy(dest, layout.header.data(), layout.header.size());
+    for (size_t i = 0; i < cols.size(); ++i) {
+        if (num_rows > 0) {
+            std::memcpy(dest + layout.data_offsets[i], cols[i].data, num_rows * cols[i].elem_size);
+        }
+    }
+}
+
+void
+write_column_file(const std::string& path, const std::vector<column_desc>& cols, size_t num_rows)
+{
+    column_layout layout = layout_columns(cols, num_rows);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::system_error{ errno, std::generic_category(), "cannot open " + path };
+    }
+    out.write(layout.header.data(), layout.header.size());
+    uint64_t pos = layout.header.size();
+    static const char padding[column_alignment] = {};
+    for (size_t i = 0; i < cols.size(); ++i) {
+        out.write(padding, layout.data_offsets[i] - pos);
+        uint64_t bytes = num_rows * cols[i].elem_size;
+        out.write(static_cast<const char*>(cols[i].data), bytes);
+        pos = layout.data_offsets[i] + bytes;
+    }
+    out.write(padding, layout.total_size - pos);
+    if (!out.flush()) {
+        throw std::system_error{ errno, std::generic_category(), "cannot write " + path };
+    }
+}
+
+std::vector<column_desc>
+parse_columns(const char* p, size_t size, size_t& num_rows, const std::string& source)
+{
+    column_file_header hdr;
+    if (size < sizeof(hdr)) {
+        bad_file(source, "too short");
+    }
+    std::memcpy(&hdr, p, sizeof(hdr));
+    if (std::memcmp(hdr.magic, column_file_magic, sizeof(hdr.magic)) != 0) {
+        bad_file(source, "bad magic number");
+    }
+    // Pairs with the fence in publish_column_file() before the magic number
+    // is written
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (hdr.num_columns > (size - sizeof(hdr)) / sizeof(column_file_entry)) {
+        bad_file(source, "truncated header");
+    }
+
+    std::vector<column_desc> out;
+    for (uint64_t i = 0; i < hdr.num_columns; ++i) {
+        column_file_entry entry;
+        std::memcpy(&entry, p + sizeof(hdr) + i * sizeof(entry), sizeof(entry));
+        if (entry.name_offset > size || entry.name_size > size - entry.name_offset) {
+            bad_file(source, "column " + std::to_string(i) + " name is out of bounds");
+        }
+        if (entry.data_offset % column_alignment != 0 || entry.data_offset > size ||
+            (entry.elem_size != 0 && hdr.num_rows > (size - entry.data_offset) / entry.elem_size)) {
+            bad_file(source, "column " + std::to_string(i) + " data is out of bounds");
+        }
+        out.push_back({ std::string{ p + entry.name_offset, entry.name_size },
+            static_cast<size_t>(entry.elem_size), p + entry.data_offset });
+    }
+    num_rows = hdr.num_rows;
+    return out;
+}
+
+void
+publish_column_file(const std::string& name, const std::vector<column_desc>& cols,
+    size_t num_rows)
+{
+#if defined(MAINFRAME_HAS_MMAP)
+    column_layout layout = layout_columns(cols, num_rows);
+
+    // Replace rather than truncate an existing object, so that processes
+    // still attached to it keep their mapping of the old frame
+    ::shm_unlink(name.c_str());
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw std::system_error{ errno, std::generic_category(), "cannot open " + name };
+    }
+    if (::ftruncate(fd, static_cast<off_t>(layout.total_size)) != 0) {
+        int err = errno;
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        throw std::system_error{ err, std::generic_category(), "cannot resize " + name };
+    }
+    void* p = ::mmap(nullptr, layout.total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int err = errno;
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        ::shm_unlink(name.c_str());
+        throw std::system_error{ err, std::generic_category(), "cannot map " + name };
+    }
+
+    // Write the magic number last so that a process attaching while this
+    // one is still copying sees an invalid header rather than partial data.
+    // The header is copied with its magic number zeroed.
+    std::memset(layout.header.data(), 0, sizeof(column_file_magic));
+    char* dest = static_cast<char*>(p);
+    copy_columns(dest, layout, cols, num_rows);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(dest, column_file_magic, sizeof(column_file_magic));
+    ::munmap(p, layout.total_size);
+#else
+    (void)cols;
+    (void)num_rows;
+    throw std::runtime_error{ "cannot publish " + name + ": no shared memory support" };
+#endif
+}
+
+void
+unpublish_column_file(const std::string& name)
+{
+#if defined(MAINFRAME_HAS_MMAP)
+    if (::shm_unlink(name.c_str()) != 0) {
+        throw std::system_error{ errno, std::generic_category(), "cannot unlink " + name };
+    }
+#else
+    throw std::runtime_error{ "cannot unlink " + name + ": no shared memory support" };
+#endif
+}
+
+mapped_file::mapped_file(const std::string& path)
+{
+#if defined(MAINFRAME_HAS_MMAP)
+    map(::open(path.c_str(), O_RDONLY), path);
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::system_error{ errno, std::generic_category(), "cannot open " + path };
+    }
+    m_size = static_cast<size_t>(in.tellg());
+    m_copy = static_cast<char*>(::operator new(m_size, std::align_val_t{ column_alignment }));
+    in.seekg(0);
+    in.read(m_copy, m_size);
+    m_data = m_copy;
+#endif
+}
+
+mapped_file::mapped_file(shared_memory_t, const std::string& name)
+{
+#if defined(MAINFRAME_HAS_MMAP)
+    map(::shm_open(name.c_str(), O_RDONLY, 0), name);
+#else
+    throw std::runtime_error{ "cannot open " + name + ": no shared memory support" };
+#endif
+}
+
+mapped_file::~mapped_file()
+{
+#if defined(MAINFRAME_HAS_MMAP)
+    if (m_copy == nullptr && m_data != nullptr) {
+        ::munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+    ::operator delete(m_copy, std::align_val_t{ column_alignment });
+}
+
+void
+mapped_file::map(int fd, const std::string& what)
+{
+#if defined(MAINFRAME_HAS_MMAP)
+    if (fd < 0) {
+        throw std::system_error{ errno, std::generic_category(), "cannot open " + what };
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::system_error{ err, std::generic_category(), "cannot stat " + what };
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size > 0) {
+        void* p = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error{ err, std::generic_category(), "cannot map " + what };
+        }
+        m_data = static_cast<const char*>(p);
+    }
+    // The mapping keeps the file open
+    ::close(fd);
+#else
+    (void)fd;
+    (void)what;
+#endif
+}
+
+} // namespace mf::detail
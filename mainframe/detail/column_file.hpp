@@ -0,0 +1,124 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_detail_column_file_h
+#define INCLUDED_mainframe_detail_column_file_h
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mf::detail
+{
+
+// A column file is a small header followed by each column's elements as a
+// raw array, every array starting on a column_alignment boundary so that
+// it can be used in place once the file is mapped:
+//
+//     column_file_header
+//     column_file_entry  x num_columns
+//     column names, back to back
+//     padding, column 0 elements, padding, column 1 elements, ...
+//
+struct column_file_header
+{
+    char magic[8];
+    uint64_t num_columns;
+    uint64_t num_rows;
+};
+
+struct column_file_entry
+{
+    uint64_t elem_size;
+    uint64_t data_offset;
+    uint64_t name_offset;
+    uint64_t name_size;
+};
+
+struct column_desc
+{
+    std::string name;
+    size_t elem_size;
+    const void* data;
+};
+
+struct column_layout
+{
+    std::vector<char> header; // header, entries and names
+    std::vector<uint64_t> data_offsets;
+    uint64_t total_size = 0;
+};
+
+column_layout
+layout_columns(const std::vector<column_desc>& cols, size_t num_rows);
+
+// Copy the header and every column into dest, which must hold
+// layout.total_size bytes
+void
+copy_columns(char* dest, const column_layout& layout, const std::vector<column_desc>& cols,
+    size_t num_rows);
+
+void
+write_column_file(const std::string& path, const std::vector<column_desc>& cols, size_t num_rows);
+
+// Create or replace the POSIX shared memory object name with a column file
+void
+publish_column_file(const std::string& name, const std::vector<column_desc>& cols,
+    size_t num_rows);
+
+void
+unpublish_column_file(const std::string& name);
+
+// Check the header of the size bytes at p and describe the columns in it.
+// Throws std::runtime_error, naming source, if they aren't a valid column
+// file
+std::vector<column_desc>
+parse_columns(const char* p, size_t size, size_t& num_rows, const std::string& source);
+
+///
+/// A whole file mapped read-only into memory, or read into the heap where
+/// mmap() isn't available. The pages are shared with the page cache, so
+/// every process that maps the same file shares one copy of it.
+///
+class mapped_file
+{
+public:
+    struct shared_memory_t
+    {};
+    static constexpr shared_memory_t shared_memory{};
+
+    explicit mapped_file(const std::string& path);
+    // Map the POSIX shared memory object name instead of a file
+    mapped_file(shared_memory_t, const std::string& name);
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file&
+    operator=(const mapped_file&) = delete;
+
+    const char*
+    data() const noexcept
+    {
+        return m_data;
+    }
+
+    size_t
+    size() const noexcept
+    {
+        return m_size;
+    }
+
+private:
+    void
+    map(int fd, const std::string& what);
+
+    const char* m_data = nullptr;
+    size_t m_size      = 0;
+    char* m_copy       = nullptr; // only without mmap()
+};
+
+} // namespace mf::detail
+
+
+#endif // INCLUDED_mainframe_detail_column_file_h
@@ -7,6 +7,8 @@
 
 #include <complex>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 #include "mainframe/frame_iterator.hpp"
 #include "mainframe/series.hpp"
@@ -432,7 +434,7 @@ struct unary_expr
         const Iter<IsConst, IsReverse, Ts...>& curr,
         const Iter<IsConst, IsReverse, Ts...>& end) const
         -> decltype(Op::exec(std::declval<T&>().
-                             operator()(curr)))
+                             operator()(begin, curr, end)))
     {
         return Op::exec(t.operator()(begin, curr, end));
     }
@@ -837,6 +839,80 @@ operator!(T t)
     return make_unary_expr<expr_op::NOT, T>::create(t);
 }
 
+namespace detail
+{
+
+// The type ex(begin, curr, end) evaluates to over rows of Iter
+template<typename Ex, typename Iter>
+using expr_result_t = decltype(std::declval<const Ex&>()(
+    std::declval<const Iter&>(), std::declval<const Iter&>(), std::declval<const Iter&>()));
+
+// Traits that let make_mask() recognise the parts of an expression it can
+// evaluate a whole column at a time instead of row by row
+template<typename Op>
+struct is_comparison_op : std::false_type
+{};
+
+template<>
+struct is_comparison_op<expr_op::GT> : std::true_type
+{};
+
+template<>
+struct is_comparison_op<expr_op::GE> : std::true_type
+{};
+
+template<>
+struct is_comparison_op<expr_op::LT> : std::true_type
+{};
+
+template<>
+struct is_comparison_op<expr_op::LE> : std::true_type
+{};
+
+template<>
+struct is_comparison_op<expr_op::EQ> : std::true_type
+{};
+
+template<>
+struct is_comparison_op<expr_op::NE> : std::true_type
+{};
+
+// A constant, such as the 20.0 in _1 > 20.0
+template<typename T>
+struct is_value_terminal : std::false_type
+{};
+
+template<typename T>
+struct is_value_terminal<terminal<T>> : std::true_type
+{};
+
+template<size_t Ind>
+struct is_value_terminal<terminal<expr_column<Ind>>> : std::false_type
+{};
+
+template<size_t Ind>
+struct is_value_terminal<terminal<indexed_expr_column<Ind>>> : std::false_type
+{};
+
+template<>
+struct is_value_terminal<terminal<row_number>> : std::false_type
+{};
+
+template<>
+struct is_value_terminal<terminal<frame_length>> : std::false_type
+{};
+
+// The current row of a column, such as the _1 in _1 > 20.0
+template<typename T>
+struct is_column_terminal : std::false_type
+{};
+
+template<size_t Ind>
+struct is_column_terminal<terminal<expr_column<Ind>>> : std::true_type
+{};
+
+} // namespace detail
+
 } // namespace mf
 
 
@@ -25,7 +25,10 @@
 #include "mainframe/frame_iterator.hpp"
 #include "mainframe/missing.hpp"
 #include "mainframe/series.hpp"
+#include "mainframe/detail/parallel.hpp"
+#include "mainframe/detail/radix_sort.hpp"
 #include "mainframe/detail/simd.hpp"
+#include "mainframe/detail/sort_key.hpp"
 
 namespace mf
 {
@@ -69,7 +72,8 @@ template<typename T, typename... Ts, size_t Curr, size_t... IndList>
 struct add_opt<frame<T, Ts...>, Curr, IndList...>
 {
     static const bool inds_contains = contains<Curr, IndList...>::value;
-    using frame_type   = typename std::conditional<inds_contains, frame<mi<T>>, frame<T>>::type;
+    using frame_type                = typename std::
+        conditional<inds_contains, frame<typename ensure_missing<T>::type>, frame<T>>::type;
     using add_opt_type = typename add_opt<frame<Ts...>, Curr + 1, IndList...>::type;
     using type         = typename combine_frames<frame_type, add_opt_type>::type;
 };
@@ -84,7 +88,8 @@ template<typename T, size_t Curr, size_t... IndList>
 struct add_opt<frame<T>, Curr, IndList...>
 {
     static const bool inds_contains = contains<Curr, IndList...>::value;
-    using type = typename std::conditional<inds_contains, frame<mi<T>>, frame<T>>::type;
+    using type                      = typename std::
+        conditional<inds_contains, frame<typename ensure_missing<T>::type>, frame<T>>::type;
 };
 
 template<typename T, size_t Curr, size_t... IndList>
@@ -102,7 +107,9 @@ struct remove_opt<frame<mi<T>, Ts...>, Curr, IndList...>
 template<typename T, typename... Ts, size_t Curr, size_t... IndList>
 struct remove_opt<frame<T, Ts...>, Curr, IndList...>
 {
-    using frame_type      = frame<T>;
+    static const bool inds_contains = contains<Curr, IndList...>::value;
+    using frame_type                = typename std::
+        conditional<inds_contains, frame<typename unwrap_missing<T>::type>, frame<T>>::type;
     using remove_opt_type = typename remove_opt<frame<Ts...>, Curr + 1, IndList...>::type;
     using type            = typename combine_frames<frame_type, remove_opt_type>::type;
 };
@@ -117,7 +124,9 @@ struct remove_opt<frame<mi<T>>, Curr, IndList...>
 template<typename T, size_t Curr, size_t... IndList>
 struct remove_opt<frame<T>, Curr, IndList...>
 {
-    using type = frame<T>;
+    static const bool inds_contains = contains<Curr, IndList...>::value;
+    using type                      = typename std::
+        conditional<inds_contains, frame<typename unwrap_missing<T>::type>, frame<T>>::type;
 };
 
 template<typename T>
@@ -134,7 +143,7 @@ template<typename T, typename... Ts>
 struct add_all_opt<frame<T, Ts...>>
 {
     using remaining_frame = typename add_all_opt<frame<Ts...>>::type;
-    using type            = typename prepend<mi<T>, remaining_frame>::type;
+    using type = typename prepend<typename ensure_missing<T>::type, remaining_frame>::type;
 };
 
 template<typename T>
@@ -146,7 +155,7 @@ struct add_all_opt<frame<mi<T>>>
 template<typename T>
 struct add_all_opt<frame<T>>
 {
-    using type = frame<mi<T>>;
+    using type = frame<typename ensure_missing<T>::type>;
 };
 
 template<>
@@ -162,7 +171,7 @@ template<typename T, typename... Ts>
 struct remove_all_opt<frame<T, Ts...>>
 {
     using remaining_frame = typename remove_all_opt<frame<Ts...>>::type;
-    using type            = typename prepend<T, remaining_frame>::type;
+    using type = typename prepend<typename unwrap_missing<T>::type, remaining_frame>::type;
 };
 
 template<typename T, typename... Ts>
@@ -181,7 +190,7 @@ struct remove_all_opt<frame<mi<T>>>
 template<typename T>
 struct remove_all_opt<frame<T>>
 {
-    using type = frame<T>;
+    using type = frame<typename unwrap_missing<T>::type>;
 };
 
 template<>
@@ -252,6 +261,126 @@ struct build_gt<Row, Ind>
     };
 };
 
+// make_mask() evaluates expressions this many rows at a time, so that the
+// intermediate words for && and || fit on the stack
+constexpr size_t mask_block_rows  = 4096;
+constexpr size_t mask_block_words = mask_block_rows / 64;
+
+// Set bit j of words to pred(j) for j in [0, num), 64 rows per word
+template<typename Pred>
+void
+fill_mask_words(uint64_t* words, size_t num, Pred&& pred)
+{
+    for (size_t w = 0; w * 64 < num; ++w) {
+        size_t n      = std::min<size_t>(64, num - w * 64);
+        uint64_t bits = 0;
+        for (size_t j = 0; j < n; ++j) {
+            bits |= uint64_t{ static_cast<bool>(pred(w * 64 + j)) } << j;
+        }
+        words[w] = bits;
+    }
+}
+
+// Compares two row indices by the key columns cols, in the order that
+// build_lt (or build_gt if Reverse) would put the rows themselves
+template<bool Reverse, typename... Ts>
+struct index_compare
+{
+    explicit index_compare(std::tuple<const Ts*...> c)
+        : cols(c)
+    {}
+
+    bool
+    operator()(size_t l, size_t r) const
+    {
+        return compare<0>(l, r);
+    }
+
+    template<size_t Ind>
+    bool
+    compare(size_t l, size_t r) const
+    {
+        const auto* c = std::get<Ind>(cols);
+        if constexpr (Ind + 1 < sizeof...(Ts)) {
+            if (c[l] == c[r]) {
+                return compare<Ind + 1>(l, r);
+            }
+        }
+        if constexpr (Reverse) {
+            return c[l] > c[r];
+        }
+        else {
+            return c[l] < c[r];
+        }
+    }
+
+    std::tuple<const Ts*...> cols;
+};
+
+// Stable-sort the row indices in order by the given columns, descending if
+// Reverse. Keys that fit in 64 bits are radix sorted, other keys that can
+// be normalized are sorted with memcmp() on their normalized form, and the
+// rest by comparing the columns. The work is spread over up to `threads`
+// threads.
+template<bool Reverse, typename... Ts>
+void
+sort_rows(std::vector<size_t>& order, unsigned threads, const Ts*... cols)
+{
+    size_t n = order.size();
+    threads  = useful_threads(threads, n);
+    if constexpr (radix_sortable<Ts...>::value) {
+        if (n >= radix_sort_min_rows) {
+            radix_argsort<Reverse>(order, threads, cols...);
+            return;
+        }
+    }
+    else if constexpr (key_sortable<Ts...>::value) {
+        if (n >= sort_key_min_rows) {
+            key_argsort<Reverse>(order, threads, cols...);
+            return;
+        }
+    }
+    index_compare<Reverse, Ts...> cmp{ std::make_tuple(cols...) };
+    if (threads > 1) {
+        std::vector<size_t> tmp(n);
+        parallel_merge_sort(order.data(), tmp.data(), n, threads, cmp,
+            [&](size_t* first, size_t* last, size_t*) { std::stable_sort(first, last, cmp); });
+    }
+    else {
+        std::stable_sort(order.begin(), order.end(), cmp);
+    }
+}
+
+// Append src[rows[0]], src[rows[1]], ... to out. Trivially copyable
+// elements are gathered on up to `threads` threads.
+template<typename T>
+void
+gather_rows(
+    const series<T>& src, const std::vector<size_t>& rows, series<T>& out, unsigned threads = 1)
+{
+    if (rows.empty()) {
+        return;
+    }
+    if constexpr (std::is_trivially_copyable<T>::value) {
+        size_t first = out.size();
+        out.resize(first + rows.size());
+        const T* s = src.data();
+        T* d       = out.data() + first;
+        parallel_for(useful_threads(threads, rows.size()), rows.size(),
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    d[i] = s[rows[i]];
+                }
+            });
+    }
+    else {
+        out.reserve(out.size() + rows.size());
+        for (size_t r : rows) {
+            out.push_back(src[r]);
+        }
+    }
+}
+
 } // namespace mf::detail
 
 #endif // INCLUDED_mainframe_detail_frame_h
@@ -187,6 +187,13 @@ public:
         : m_frame(f)
     {}
 
+    // Index only the given rows of f
+    frame_indexer(frame<Ts...> f, std::vector<size_t> rows)
+        : m_frame(f)
+        , m_rows(std::move(rows))
+        , m_some_rows(true)
+    {}
+
     using iterator                 = typename frame<Ts...>::iterator;
     using const_iterator           = typename frame<Ts...>::const_iterator;
     using index_iterator           = typename map_type::iterator;
@@ -322,9 +329,11 @@ public:
         }
 
         const index_frame ifr{ get_index_frame::op(m_frame) };
-        m_idx.reserve(ifr.size());
+        size_t num_rows = m_some_rows ? m_rows.size() : ifr.size();
+        m_idx.reserve(num_rows);
 
-        for (size_t i = 0; i < ifr.size(); ++i) {
+        for (size_t n = 0; n < num_rows; ++n) {
+            size_t i    = m_some_rows ? m_rows[n] : n;
             auto row    = ifr.row(i);
             auto findit = m_idx.find(row);
             if (findit == m_idx.end()) {
@@ -363,6 +372,8 @@ public:
 protected:
     mutable map_type m_idx;
     frame<Ts...> m_frame;
+    std::vector<size_t> m_rows;
+    bool m_some_rows = false;
 };
 
 } // namespace mf
@@ -0,0 +1,382 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "mainframe/memory_resource.hpp"
+
+namespace mf
+{
+
+namespace
+{
+
+#if defined(__linux__)
+// Blocks at least this large are mapped directly so that growing them can
+// use mremap() and let the kernel move page tables instead of copying bytes
+constexpr size_t mmap_threshold = size_t{ 1 } << 20;
+
+size_t
+page_round(size_t bytes)
+{
+    static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return (bytes + page - 1) / page * page;
+}
+
+bool
+use_mmap(size_t bytes, size_t alignment)
+{
+    return bytes >= mmap_threshold && alignment <= page_round(1);
+}
+#endif
+
+class aligned_heap : public memory_resource
+{
+protected:
+    void*
+    do_allocate(size_t bytes, size_t alignment) override
+    {
+#if defined(__linux__)
+        if (use_mmap(bytes, alignment)) {
+            void* p = mmap(nullptr, page_round(bytes), PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) {
+                throw std::bad_alloc{};
+            }
+            return p;
+        }
+#endif
+        return ::operator new(bytes, std::align_val_t{ alignment });
+    }
+
+    void
+    do_deallocate(void* p, size_t bytes, size_t alignment) override
+    {
+#if defined(__linux__)
+        if (use_mmap(bytes, alignment)) {
+            munmap(p, page_round(bytes));
+            return;
+        }
+#endif
+        ::operator delete(p, std::align_val_t{ alignment });
+    }
+
+    void*
+    do_reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment) override
+    {
+#if defined(__linux__)
+        if (use_mmap(old_bytes, alignment) && use_mmap(new_bytes, alignment)) {
+            void* np = mremap(p, page_round(old_bytes), page_round(new_bytes), MREMAP_MAYMOVE);
+            if (np == MAP_FAILED) {
+                throw std::bad_alloc{};
+            }
+            return np;
+        }
+#endif
+        return memory_resource::do_reallocate(p, old_bytes, new_bytes, alignment);
+    }
+};
+
+#if defined(__linux__)
+constexpr size_t huge_page_size = size_t{ 2 } << 20;
+
+// From <linux/mempolicy.h>, spelled out to avoid depending on libnuma's
+// <numaif.h>
+constexpr int mpol_preferred           = 1;
+constexpr int mpol_interleave          = 3;
+constexpr int mpol_local               = 4;
+constexpr int mpol_f_mems_allowed      = 1 << 2;
+constexpr unsigned long max_numa_nodes = 1024;
+constexpr size_t bits_per_word         = 8 * sizeof(unsigned long);
+constexpr size_t nodemask_words        = max_numa_nodes / bits_per_word;
+
+size_t
+huge_page_round(size_t bytes)
+{
+    return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+}
+
+// Map len bytes starting on a huge page boundary, which transparent huge
+// pages need
+void*
+map_huge_aligned(size_t len)
+{
+    size_t span = len + huge_page_size;
+    void* p     = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        return nullptr;
+    }
+    auto addr    = reinterpret_cast<uintptr_t>(p);
+    auto aligned = (addr + huge_page_size - 1) / huge_page_size * huge_page_size;
+    if (aligned != addr) {
+        munmap(p, aligned - addr);
+    }
+    size_t tail = (addr + span) - (aligned + len);
+    if (tail != 0) {
+        munmap(reinterpret_cast<void*>(aligned + len), tail);
+    }
+    return reinterpret_cast<void*>(aligned);
+}
+
+// Set the NUMA policy of [p, p + len) before any of it is touched
+void
+place(void* p, size_t len, numa_placement placement, int node)
+{
+    unsigned long mask[nodemask_words] = {};
+    int mode                           = 0;
+    switch (placement) {
+    case numa_placement::any:
+        return;
+    case numa_placement::local:
+        mode = mpol_local;
+        break;
+    case numa_placement::interleave:
+        if (syscall(SYS_get_mempolicy, nullptr, mask, max_numa_nodes, nullptr,
+                mpol_f_mems_allowed) != 0) {
+            return;
+        }
+        mode = mpol_interleave;
+        break;
+    case numa_placement::node:
+        if (node < 0 || static_cast<unsigned long>(node) >= max_numa_nodes) {
+            return;
+        }
+        mask[node / bits_per_word] |= 1UL << (node % bits_per_word);
+        mode = mpol_preferred;
+        break;
+    }
+    bool empty_mask = mode == mpol_local;
+    syscall(SYS_mbind, p, len, mode, empty_mask ? nullptr : mask,
+        empty_mask ? 0 : max_numa_nodes, 0);
+}
+#endif
+
+std::atomic<memory_resource*>&
+default_resource_slot()
+{
+    static std::atomic<memory_resource*> slot{ aligned_heap_resource() };
+    return slot;
+}
+
+thread_local memory_resource* t_thread_resource = nullptr;
+
+std::atomic<growth_policy>&
+growth_policy_slot()
+{
+    static std::atomic<growth_policy> slot{ growth_policy::power_of_two };
+    return slot;
+}
+
+} // namespace
+
+arena_resource::arena_resource(size_t chunk_size, memory_resource* upstream) noexcept
+    : m_next_chunk_size(std::max(chunk_size, sizeof(chunk) + column_alignment))
+    , m_upstream(upstream != nullptr ? upstream : aligned_heap_resource())
+{}
+
+arena_resource::~arena_resource()
+{
+    release();
+}
+
+void
+arena_resource::release() noexcept
+{
+    while (m_chunks != nullptr) {
+        chunk* prev = m_chunks->prev;
+        m_upstream->deallocate(m_chunks, m_chunks->size, column_alignment);
+        m_chunks = prev;
+    }
+    m_cur = m_end = m_last = nullptr;
+    m_used                 = 0;
+}
+
+void*
+arena_resource::do_allocate(size_t bytes, size_t alignment)
+{
+    auto align_up = [alignment](char* p) {
+        auto addr = reinterpret_cast<uintptr_t>(p);
+        return reinterpret_cast<char*>((addr + alignment - 1) / alignment * alignment);
+    };
+    char* p = m_cur == nullptr ? nullptr : align_up(m_cur);
+    if (p == nullptr || p > m_end || static_cast<size_t>(m_end - p) < bytes) {
+        // Chunks double in size so that an arena needs few of them
+        size_t size       = std::max(m_next_chunk_size, sizeof(chunk) + alignment + bytes);
+        m_next_chunk_size = size * 2;
+
+        auto* c  = static_cast<chunk*>(m_upstream->allocate(size, column_alignment));
+        c->prev  = m_chunks;
+        c->size  = size;
+        m_chunks = c;
+        m_end    = reinterpret_cast<char*>(c) + size;
+        p        = align_up(reinterpret_cast<char*>(c + 1));
+    }
+    m_cur  = p + bytes;
+    m_last = p;
+    m_used += bytes;
+    return p;
+}
+
+void
+arena_resource::do_deallocate(void* p, size_t bytes, size_t)
+{
+    if (p == m_last && m_last + bytes == m_cur) {
+        m_cur = m_last;
+        m_used -= bytes;
+        m_last = nullptr;
+    }
+}
+
+void*
+arena_resource::do_reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment)
+{
+    if (p != nullptr && p == m_last && m_last + old_bytes == m_cur &&
+        new_bytes <= static_cast<size_t>(m_end - m_last)) {
+        m_cur = m_last + new_bytes;
+        m_used += new_bytes;
+        m_used -= old_bytes;
+        return p;
+    }
+    return memory_resource::do_reallocate(p, old_bytes, new_bytes, alignment);
+}
+
+huge_page_resource::huge_page_resource() noexcept
+    : huge_page_resource(options{})
+{}
+
+huge_page_resource::huge_page_resource(const options& opts, memory_resource* upstream) noexcept
+    : m_options(opts)
+    , m_upstream(upstream != nullptr ? upstream : aligned_heap_resource())
+{}
+
+void*
+huge_page_resource::do_allocate(size_t bytes, size_t alignment)
+{
+    if (!is_large(bytes)) {
+        return m_upstream->allocate(bytes, alignment);
+    }
+#if defined(__linux__)
+    size_t len = huge_page_round(bytes);
+    void* p    = nullptr;
+    if (m_options.pages == huge_pages::hugetlb) {
+        p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p == MAP_FAILED) {
+            p = nullptr;
+        }
+    }
+    if (p == nullptr) {
+        p = map_huge_aligned(len);
+        if (p == nullptr) {
+            throw std::bad_alloc{};
+        }
+        madvise(p, len, m_options.pages == huge_pages::none ? MADV_NOHUGEPAGE : MADV_HUGEPAGE);
+    }
+    place(p, len, m_options.placement, m_options.node);
+    return p;
+#else
+    return m_upstream->allocate(bytes, alignment);
+#endif
+}
+
+void
+huge_page_resource::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+    if (!is_large(bytes)) {
+        m_upstream->deallocate(p, bytes, alignment);
+        return;
+    }
+#if defined(__linux__)
+    munmap(p, huge_page_round(bytes));
+#else
+    m_upstream->deallocate(p, bytes, alignment);
+#endif
+}
+
+void*
+huge_page_resource::do_reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment)
+{
+    if (!is_large(old_bytes) && !is_large(new_bytes)) {
+        return m_upstream->reallocate(p, old_bytes, new_bytes, alignment);
+    }
+    return memory_resource::do_reallocate(p, old_bytes, new_bytes, alignment);
+}
+
+bool
+huge_page_resource::is_large(size_t bytes) const noexcept
+{
+#if defined(__linux__)
+    return bytes >= m_options.threshold;
+#else
+    (void)bytes;
+    return false;
+#endif
+}
+
+void*
+memory_resource::do_reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment)
+{
+    void* np = allocate(new_bytes, alignment);
+    if (p != nullptr) {
+        std::memcpy(np, p, std::min(old_bytes, new_bytes));
+        deallocate(p, old_bytes, alignment);
+    }
+    return np;
+}
+
+memory_resource*
+aligned_heap_resource() noexcept
+{
+    static aligned_heap heap;
+    return &heap;
+}
+
+memory_resource*
+get_default_resource() noexcept
+{
+    if (t_thread_resource != nullptr) {
+        return t_thread_resource;
+    }
+    return default_resource_slot().load(std::memory_order_acquire);
+}
+
+memory_resource*
+set_default_resource(memory_resource* resource) noexcept
+{
+    if (resource == nullptr) {
+        resource = aligned_heap_resource();
+    }
+    return default_resource_slot().exchange(resource, std::memory_order_acq_rel);
+}
+
+memory_resource*
+detail::exchange_thread_resource(memory_resource* resource) noexcept
+{
+    return std::exchange(t_thread_resource, resource);
+}
+
+growth_policy
+get_growth_policy() noexcept
+{
+    return growth_policy_slot().load(std::memory_order_relaxed);
+}
+
+growth_policy
+set_growth_policy(growth_policy policy) noexcept
+{
+    return growth_policy_slot().exchange(policy, std::memory_order_relaxed);
+}
+
+} // namespace mf
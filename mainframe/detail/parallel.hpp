@@ -0,0 +1,196 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_detail_parallel_h
+#define INCLUDED_mainframe_detail_parallel_h
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace mf::detail
+{
+
+// Each thread gets at least this many rows, so small frames don't pay for
+// starting threads that would have nothing to do
+constexpr size_t parallel_grain = size_t{ 1 } << 15;
+
+// The number of threads worth using for n rows, between 1 and threads
+inline unsigned
+useful_threads(unsigned threads, size_t n)
+{
+    size_t most = std::max<size_t>(1, n / parallel_grain);
+    return static_cast<unsigned>(std::clamp<size_t>(threads, 1, most));
+}
+
+// Call fn(0), fn(1), ..., fn(num_tasks - 1) on up to `threads` threads, the
+// calling thread included. If fn throws, the remaining tasks are abandoned
+// and the first exception is rethrown once every thread has finished. If
+// threads can't be started, the ones that did start do all the work.
+template<typename Fn>
+void
+run_tasks(unsigned threads, size_t num_tasks, Fn fn)
+{
+    size_t num_threads = std::min<size_t>(threads, num_tasks);
+    if (num_threads <= 1) {
+        for (size_t i = 0; i < num_tasks; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next{ 0 };
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto work = [&] {
+        try {
+            for (size_t i = next++; i < num_tasks; i = next++) {
+                fn(i);
+            }
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock{ error_mutex };
+            if (!error) {
+                error = std::current_exception();
+            }
+            next = num_tasks;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(num_threads - 1);
+    try {
+        for (size_t t = 1; t < num_threads; ++t) {
+            pool.emplace_back(work);
+        }
+    }
+    catch (const std::system_error&) {
+    }
+    work();
+    for (auto& t : pool) {
+        t.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// Call fn(begin, end) for `threads` contiguous ranges that cover [0, n)
+template<typename Fn>
+void
+parallel_for(unsigned threads, size_t n, Fn fn)
+{
+    run_tasks(threads, threads, [&](size_t t) {
+        size_t begin = n * t / threads;
+        size_t end   = n * (t + 1) / threads;
+        if (begin < end) {
+            fn(begin, end);
+        }
+    });
+}
+
+// How many of the first i elements of the stable merge of a and b come from
+// a, where a's elements go first among equals
+template<typename E, typename Compare>
+size_t
+merge_split(const E* a, size_t na, const E* b, size_t nb, size_t i, Compare comp)
+{
+    size_t lo = i > nb ? i - nb : 0;
+    size_t hi = std::min(i, na);
+    while (lo < hi) {
+        size_t j = lo + (hi - lo) / 2;
+        if (!comp(b[i - j - 1], a[j])) {
+            lo = j + 1;
+        }
+        else {
+            hi = j;
+        }
+    }
+    return lo;
+}
+
+// Stable sort of data[0, n) on `threads` threads. The range is cut into a
+// chunk per thread, each chunk is sorted by sort_chunk(first, last,
+// scratch) - where scratch has room for last - first elements - and the
+// sorted runs are then merged pairwise. Every merge is split at the points
+// where its output divides evenly between the threads, so the last rounds,
+// with only one or two merges left, still keep every thread busy. tmp must
+// have room for n elements.
+template<typename E, typename Compare, typename SortChunk>
+void
+parallel_merge_sort(E* data, E* tmp, size_t n, unsigned threads, Compare comp,
+    SortChunk sort_chunk)
+{
+    std::vector<size_t> runs(threads + 1);
+    for (size_t t = 0; t <= threads; ++t) {
+        runs[t] = n * t / threads;
+    }
+    run_tasks(threads, threads, [&](size_t t) {
+        sort_chunk(data + runs[t], data + runs[t + 1], tmp + runs[t]);
+    });
+
+    struct piece
+    {
+        size_t a_begin;
+        size_t a_end;
+        size_t b_begin;
+        size_t b_end;
+        size_t out;
+    };
+
+    E* src = data;
+    E* dst = tmp;
+    while (runs.size() > 2) {
+        size_t num_runs   = runs.size() - 1;
+        size_t num_merges = num_runs / 2;
+        size_t splits     = std::max<size_t>(1, threads / num_merges);
+        std::vector<piece> pieces;
+        std::vector<size_t> next_runs;
+        for (size_t r = 0; r < num_runs; r += 2) {
+            next_runs.push_back(runs[r]);
+            if (r + 1 == num_runs) {
+                // an odd run out is carried over to the next round as is
+                pieces.push_back({ runs[r], runs[r + 1], runs[r + 1], runs[r + 1], runs[r] });
+                continue;
+            }
+            const E* a = src + runs[r];
+            const E* b = src + runs[r + 1];
+            size_t na  = runs[r + 1] - runs[r];
+            size_t nb  = runs[r + 2] - runs[r + 1];
+            size_t j0  = 0;
+            for (size_t s = 0; s < splits; ++s) {
+                size_t i0 = (na + nb) * s / splits;
+                size_t i1 = (na + nb) * (s + 1) / splits;
+                size_t j1 = merge_split(a, na, b, nb, i1, comp);
+                pieces.push_back({ runs[r] + j0, runs[r] + j1, runs[r + 1] + (i0 - j0),
+                    runs[r + 1] + (i1 - j1), runs[r] + i0 });
+                j0 = j1;
+            }
+        }
+        next_runs.push_back(n);
+
+        run_tasks(threads, pieces.size(), [&](size_t p) {
+            const piece& pc = pieces[p];
+            std::merge(src + pc.a_begin, src + pc.a_end, src + pc.b_begin, src + pc.b_end,
+                dst + pc.out, comp);
+        });
+        std::swap(src, dst);
+        runs = std::move(next_runs);
+    }
+
+    if (src != data) {
+        parallel_for(threads, n, [&](size_t begin, size_t end) {
+            std::copy(src + begin, src + end, data + begin);
+        });
+    }
+}
+
+} // namespace mf::detail
+
+
+#endif // INCLUDED_mainframe_detail_parallel_h
@@ -0,0 +1,290 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_detail_radix_sort_h
+#define INCLUDED_mainframe_detail_radix_sort_h
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "mainframe/detail/parallel.hpp"
+
+namespace mf::detail
+{
+
+// Below this many rows a comparison sort is as fast and needs no buffers
+constexpr size_t radix_sort_min_rows = 1024;
+
+// Keys are packed into one integer per row, so multi-column keys wider than
+// this are sorted by comparison
+constexpr size_t radix_max_key_bytes = 8;
+
+// radix_key<T> maps a T to an unsigned integer whose natural order is the
+// order of T's operator<, so that values can be sorted a byte at a time.
+// value is false for types that have no such mapping.
+template<typename T, typename = void>
+struct radix_key : std::false_type
+{};
+
+template<typename T>
+struct radix_key<T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value>>
+    : std::true_type
+{
+    using type = std::make_unsigned_t<T>;
+
+    static type
+    encode(T t)
+    {
+        type u = static_cast<type>(t);
+        if constexpr (std::is_signed<T>::value) {
+            u = static_cast<type>(u ^ (type{ 1 } << (std::numeric_limits<type>::digits - 1)));
+        }
+        return u;
+    }
+};
+
+// Positive floats get their sign bit set and negative ones are inverted, so
+// that larger magnitudes of negatives sort first. -0.0 is folded into 0.0
+// since the two compare equal. NaNs sort after +inf, or before -inf if
+// their sign bit is set.
+template<typename T>
+struct radix_key<T,
+    std::enable_if_t<std::is_floating_point<T>::value && std::numeric_limits<T>::is_iec559 &&
+        (sizeof(T) == 4 || sizeof(T) == 8)>> : std::true_type
+{
+    using type = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+
+    static type
+    encode(T t)
+    {
+        if (t == T{ 0 }) {
+            t = T{ 0 };
+        }
+        type u;
+        std::memcpy(&u, &t, sizeof(u));
+        constexpr type sign = type{ 1 } << (std::numeric_limits<type>::digits - 1);
+        return (u & sign) ? static_cast<type>(~u) : static_cast<type>(u | sign);
+    }
+};
+
+template<typename Rep, typename Period>
+struct radix_key<std::chrono::duration<Rep, Period>, std::enable_if_t<radix_key<Rep>::value>>
+    : std::true_type
+{
+    using type = typename radix_key<Rep>::type;
+
+    static type
+    encode(const std::chrono::duration<Rep, Period>& d)
+    {
+        return radix_key<Rep>::encode(d.count());
+    }
+};
+
+template<typename Clock, typename Duration>
+struct radix_key<std::chrono::time_point<Clock, Duration>,
+    std::enable_if_t<radix_key<Duration>::value>> : std::true_type
+{
+    using type = typename radix_key<Duration>::type;
+
+    static type
+    encode(const std::chrono::time_point<Clock, Duration>& t)
+    {
+        return radix_key<Duration>::encode(t.time_since_epoch());
+    }
+};
+
+// Calendar dates like date::year_month_day, which order by year, then month,
+// then day. The year is a short and the month and day fit in a byte each.
+template<typename T>
+struct radix_key<T,
+    std::void_t<decltype(static_cast<int>(std::declval<const T&>().year())),
+        decltype(static_cast<unsigned>(std::declval<const T&>().month())),
+        decltype(static_cast<unsigned>(std::declval<const T&>().day()))>> : std::true_type
+{
+    using type = uint32_t;
+
+    static type
+    encode(const T& t)
+    {
+        uint32_t y = static_cast<uint32_t>(static_cast<int>(t.year()) + 32768) & 0xffff;
+        uint32_t m = static_cast<unsigned>(t.month()) & 0xff;
+        uint32_t d = static_cast<unsigned>(t.day()) & 0xff;
+        return (y << 16) | (m << 8) | d;
+    }
+};
+
+template<typename T>
+constexpr size_t
+radix_key_bytes()
+{
+    if constexpr (radix_key<T>::value) {
+        return sizeof(typename radix_key<T>::type);
+    }
+    else {
+        return 0;
+    }
+}
+
+// Whether rows can be radix sorted by columns of these types
+template<typename... Ts>
+struct radix_sortable
+    : std::bool_constant<(radix_key<Ts>::value && ...) &&
+          (radix_key_bytes<Ts>() + ...) <= radix_max_key_bytes>
+{};
+
+// Stable LSD radix sort of data[0, n) by key(element), an unsigned integer,
+// radix_digit_bits bits per pass. tmp must have room for n elements. A pass
+// in which every element has the same digit is skipped, so narrow values
+// in a wide key cost one histogram rather than a scatter per digit.
+constexpr size_t radix_digit_bits = 11;
+
+template<typename E, typename KeyFn>
+void
+radix_sort(E* data, E* tmp, size_t n, KeyFn key)
+{
+    static_assert(std::is_trivially_copyable<E>::value);
+    using K                 = decltype(key(*data));
+    constexpr size_t bits   = std::numeric_limits<K>::digits;
+    constexpr size_t passes = (bits + radix_digit_bits - 1) / radix_digit_bits;
+    constexpr size_t radix  = size_t{ 1 } << radix_digit_bits;
+    constexpr K digit_mask  = static_cast<K>(radix - 1);
+    if (n < 2) {
+        return;
+    }
+
+    std::vector<std::array<size_t, radix>> counts(passes);
+    for (size_t i = 0; i < n; ++i) {
+        K k = key(data[i]);
+        for (size_t p = 0; p < passes; ++p) {
+            ++counts[p][(k >> (radix_digit_bits * p)) & digit_mask];
+        }
+    }
+
+    E* src = data;
+    E* dst = tmp;
+    for (size_t p = 0; p < passes; ++p) {
+        auto& c     = counts[p];
+        size_t shift = radix_digit_bits * p;
+        if (c[(key(src[0]) >> shift) & digit_mask] == n) {
+            continue;
+        }
+        size_t sum = 0;
+        for (size_t& v : c) {
+            size_t cnt = v;
+            v          = sum;
+            sum += cnt;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            dst[c[(key(src[i]) >> shift) & digit_mask]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    if (src != data) {
+        std::memcpy(data, src, n * sizeof(E));
+    }
+}
+
+// The keys of one row packed into a single integer, first column in the
+// high bits
+template<typename... Ts, size_t... Is>
+uint64_t
+packed_radix_key(const std::tuple<const Ts*...>& cols, size_t row, std::index_sequence<Is...>)
+{
+    if constexpr (sizeof...(Ts) == 1) {
+        return radix_key<Ts...>::encode(std::get<0>(cols)[row]);
+    }
+    else {
+        uint64_t k = 0;
+        ((k = (k << (8 * radix_key_bytes<Ts>())) | radix_key<Ts>::encode(std::get<Is>(cols)[row])),
+            ...);
+        return k;
+    }
+}
+
+// Stable-sort the row indices in order by (cols[0][row], cols[1][row], ...),
+// descending if Reverse. The row order doesn't need to start out sorted.
+// With more than one thread, each sorts a chunk of the rows and the chunks
+// are merged on their keys.
+template<bool Reverse, typename... Ts>
+void
+radix_argsort(std::vector<size_t>& order, unsigned threads, const Ts*... cols)
+{
+    static_assert(radix_sortable<Ts...>::value);
+    using K = std::conditional_t<(radix_key_bytes<Ts>() + ...) <= sizeof(uint32_t), uint32_t,
+        uint64_t>;
+    struct entry
+    {
+        K key;
+        size_t row;
+    };
+    auto key = [](const entry& e) { return e.key; };
+
+    auto tcols = std::make_tuple(cols...);
+    size_t n   = order.size();
+    std::vector<entry> a(n);
+    std::vector<entry> tmp(n);
+    parallel_for(threads, n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            K k = static_cast<K>(
+                packed_radix_key(tcols, order[i], std::index_sequence_for<Ts...>{}));
+            a[i] = entry{ Reverse ? static_cast<K>(~k) : k, order[i] };
+        }
+    });
+    if (threads > 1) {
+        parallel_merge_sort(
+            a.data(), tmp.data(), n, threads,
+            [](const entry& l, const entry& r) { return l.key < r.key; },
+            [&](entry* first, entry* last, entry* scratch) {
+                radix_sort(first, scratch, static_cast<size_t>(last - first), key);
+            });
+    }
+    else {
+        radix_sort(a.data(), tmp.data(), n, key);
+    }
+    parallel_for(threads, n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            order[i] = a[i].row;
+        }
+    });
+}
+
+// Sort the values in data[0, n), descending if Reverse. Types with a
+// radix_key are radix sorted once there are enough of them.
+template<bool Reverse, typename T>
+void
+sort_values(T* data, size_t n)
+{
+    if constexpr (radix_key<T>::value && std::is_trivially_copyable<T>::value) {
+        if (n >= radix_sort_min_rows) {
+            using key = radix_key<T>;
+            using K   = typename key::type;
+            std::vector<T> tmp(n);
+            radix_sort(data, tmp.data(), n, [](const T& t) {
+                K k = key::encode(t);
+                return Reverse ? static_cast<K>(~k) : k;
+            });
+            return;
+        }
+    }
+    if constexpr (Reverse) {
+        std::stable_sort(data, data + n, std::greater<T>{});
+    }
+    else {
+        std::stable_sort(data, data + n);
+    }
+}
+
+} // namespace mf::detail
+
+
+#endif // INCLUDED_mainframe_detail_radix_sort_h
@@ -6,6 +6,7 @@
 #define INCLUDED_mainframe_detail_series_vector_h
 
 #include <algorithm>
+#include <cstring>
 #include <ios>
 #include <iostream>
 #include <list>
@@ -21,6 +22,7 @@
 #include <vector>
 
 #include "mainframe/detail/base.hpp"
+#include "mainframe/memory_resource.hpp"
 
 namespace mf::detail
 {
@@ -257,20 +259,22 @@ class series_vector : public iseries_vector
 {
     static constexpr bool is_move_constructible = std::is_move_constructible<T>::value;
     static constexpr bool is_move_assignable    = std::is_move_assignable<T>::value;
+    static constexpr bool is_trivial            = std::is_trivially_copyable<T>::value;
+    static constexpr size_t alignment           = std::max(column_alignment, alignof(T));
 
 public:
-    static const size_t DEFAULT_SIZE = 32;
-    using value_type                 = T;
-    using size_type                  = size_t;
-    using difference_type            = ptrdiff_t;
-    using reference                  = value_type&;
-    using const_reference            = const value_type&;
-    using pointer                    = value_type*;
-    using const_pointer              = const value_type*;
-    using iterator                   = sv_iterator<T>;
-    using const_iterator             = const_sv_iterator<T>;
-    using reverse_iterator           = reverse_sv_iterator<T>;
-    using const_reverse_iterator     = const_reverse_sv_iterator<T>;
+    static constexpr size_t DEFAULT_SIZE = 32;
+    using value_type                     = T;
+    using size_type                      = size_t;
+    using difference_type                = ptrdiff_t;
+    using reference                      = value_type&;
+    using const_reference                = const value_type&;
+    using pointer                        = value_type*;
+    using const_pointer                  = const value_type*;
+    using iterator                       = sv_iterator<T>;
+    using const_iterator                 = const_sv_iterator<T>;
+    using reverse_iterator               = reverse_sv_iterator<T>;
+    using const_reverse_iterator         = const_reverse_sv_iterator<T>;
 
     template<typename U, template<typename, typename> typename Func>
     series_vector<U>
@@ -283,11 +287,15 @@ public:
         return out;
     }
 
-    series_vector()
-    {
-        create_storage(DEFAULT_SIZE);
-    }
+    // No storage is allocated until the first element arrives
+    series_vector() noexcept
+        : m_resource(get_default_resource())
+    {}
+    explicit series_vector(memory_resource* resource) noexcept
+        : m_resource(resource)
+    {}
     series_vector(size_type count, const T& value)
+        : m_resource(get_default_resource())
     {
         create_storage(count);
         for (; m_end != m_begin + count; ++m_end) {
@@ -295,6 +303,7 @@ public:
         }
     }
     explicit series_vector(size_type count)
+        : m_resource(get_default_resource())
     {
         create_storage(count);
         for (; m_end != m_begin + count; ++m_end) {
@@ -303,6 +312,7 @@ public:
     }
     template<typename InputIt>
     series_vector(InputIt f, InputIt l)
+        : m_resource(get_default_resource())
     {
         auto count = l - f;
         create_storage(count);
@@ -312,50 +322,66 @@ public:
         }
     }
     series_vector(const series_vector& other)
-    {
-        create_storage(other.capacity());
-        auto* curr = other.m_begin;
-        for (; curr != other.m_end; ++curr, ++m_end) {
-            new (m_end) T{ *curr };
+        : series_vector(other, other.m_resource)
+    {}
+    // Copy other into storage allocated from resource
+    series_vector(const series_vector& other, memory_resource* resource)
+        : m_resource(resource)
+    {
+        create_storage(other.size());
+        if constexpr (is_trivial) {
+            if (!other.empty()) {
+                std::memcpy(m_begin, other.m_begin, other.size() * sizeof(T));
+            }
+            m_end = m_begin + other.size();
+        }
+        else {
+            auto* curr = other.m_begin;
+            for (; curr != other.m_end; ++curr, ++m_end) {
+                new (m_end) T{ *curr };
+            }
         }
     }
-    series_vector(series_vector&& other)
+    series_vector(series_vector&& other) noexcept
+        : m_resource(other.m_resource)
     {
-        create_storage(DEFAULT_SIZE);
-        std::swap(m_begin, other.m_begin);
-        std::swap(m_end, other.m_end);
-        std::swap(m_max, other.m_max);
+        swap_storage(other);
     }
     explicit series_vector(std::initializer_list<T> _init)
         : series_vector(_init.begin(), _init.end())
     {}
+    // View [first, last) of a buffer kept alive by owner without copying it.
+    // A borrowed vector never writes to or frees the buffer; anything that
+    // would modify it copies the elements into storage of its own first
+    series_vector(std::shared_ptr<const void> owner, const T* first, const T* last)
+        : m_begin(const_cast<T*>(first))
+        , m_end(const_cast<T*>(last))
+        , m_max(const_cast<T*>(last))
+        , m_resource(get_default_resource())
+        , m_owner(std::move(owner))
+    {}
 
     virtual ~series_vector()
     {
-        destroy(m_begin, m_end);
-        free(m_begin);
+        if (!borrowed()) {
+            destroy(m_begin, m_end);
+            deallocate(m_begin, capacity());
+        }
     }
 
     series_vector&
     operator=(const series_vector& in)
     {
         series_vector other{ in };
-        std::swap(m_begin, other.m_begin);
-        std::swap(m_end, other.m_end);
-        std::swap(m_max, other.m_max);
+        swap_storage(other);
         return *this;
     }
 
     series_vector&
-    operator=(series_vector&& in)
+    operator=(series_vector&& in) noexcept
     {
-        series_vector other;
-        std::swap(in.m_begin, other.m_begin);
-        std::swap(in.m_end, other.m_end);
-        std::swap(in.m_max, other.m_max);
-        std::swap(m_begin, other.m_begin);
-        std::swap(m_end, other.m_end);
-        std::swap(m_max, other.m_max);
+        series_vector other{ std::move(in) };
+        swap_storage(other);
         return *this;
     }
 
@@ -363,9 +389,7 @@ public:
     operator=(std::initializer_list<T> init)
     {
         series_vector other{ init };
-        std::swap(m_begin, other.m_begin);
-        std::swap(m_end, other.m_end);
-        std::swap(m_max, other.m_max);
+        swap_storage(other);
         return *this;
     }
 
@@ -561,9 +585,19 @@ public:
     void
     reserve(size_type newsize)
     {
-        if (newsize > capacity()) {
-            size_t n  = pow_2(newsize);
-            T* nbegin = static_cast<T*>(malloc(n * sizeof(T)));
+        if (borrowed()) {
+            detach(newsize);
+        }
+        else if (newsize > capacity()) {
+            size_t n = grown_capacity(newsize);
+            if constexpr (is_trivial) {
+                size_t count = size();
+                m_begin      = reallocate(m_begin, capacity(), n);
+                m_end        = m_begin + count;
+                m_max        = m_begin + n;
+                return;
+            }
+            T* nbegin = allocate(n);
             T* nend   = placement_move(m_begin, m_end, nbegin);
             clear();
             m_begin = nbegin;
@@ -579,11 +613,58 @@ public:
     void
     clear() noexcept
     {
-        destroy(m_begin, m_end);
-        free(m_begin);
+        if (borrowed()) {
+            m_owner.reset();
+        }
+        else {
+            destroy(m_begin, m_end);
+            deallocate(m_begin, capacity());
+        }
         m_begin = m_end = m_max = nullptr;
     }
 
+    // Reallocate to exactly size(), or release the storage if empty. A
+    // borrowed vector copies its elements into a buffer of its own so that
+    // it stops keeping the owner's alive
+    void
+    shrink_to_fit()
+    {
+        if (borrowed()) {
+            detach(size());
+        }
+        if (size() == capacity()) {
+            return;
+        }
+        if (empty()) {
+            clear();
+            return;
+        }
+        size_t count = size();
+        if constexpr (is_trivial) {
+            m_begin = reallocate(m_begin, capacity(), count);
+        }
+        else {
+            T* nbegin = allocate(count);
+            placement_move(m_begin, m_end, nbegin);
+            clear();
+            m_begin = nbegin;
+        }
+        m_end = m_max = m_begin + count;
+    }
+
+    // True if the elements live in a buffer owned by something else
+    bool
+    borrowed() const noexcept
+    {
+        return m_owner != nullptr;
+    }
+
+    memory_resource*
+    get_memory_resource() const noexcept
+    {
+        return m_resource;
+    }
+
     template<typename U>
     iterator
     insert(const_iterator cpos, U&& value)
@@ -694,6 +775,13 @@ public:
     iterator
     erase(const_iterator cfst, const_iterator clst)
     {
+        if (borrowed()) {
+            auto offset = cfst - cbegin();
+            auto count  = clst - cfst;
+            detach(size());
+            cfst = cbegin() + offset;
+            clst = cfst + count;
+        }
         auto fst = remove_const(cfst);
         auto lst = remove_const(clst);
 #ifdef MFDEBUG
@@ -701,7 +789,14 @@ public:
             throw std::invalid_argument{ "erase() invalid argument" };
         }
 #endif
-        if (fst != lst) {
+        if (fst == lst) {
+            return fst;
+        }
+        if constexpr (is_trivial) {
+            std::memmove(&*fst, &*lst, (m_end - &*lst) * sizeof(T));
+            m_end -= lst - fst;
+        }
+        else {
             auto icurr = &*lst;
             auto ocurr = &*fst;
             auto count = lst - fst;
@@ -741,6 +836,9 @@ public:
     void
     resize(size_type newsize)
     {
+        if (borrowed()) {
+            detach(newsize);
+        }
         if (newsize > size()) {
             if constexpr (std::is_default_constructible<T>::value) {
                 reserve(newsize);
@@ -756,15 +854,16 @@ public:
             }
         }
         else {
-            for (T* curr = m_begin + newsize; curr != m_end; ++curr) {
-                curr->~T();
-            }
+            destroy(m_begin + newsize, m_end);
             m_end = m_begin + newsize;
         }
     }
     void
     resize(size_type newsize, const value_type& value)
     {
+        if (borrowed()) {
+            detach(newsize);
+        }
         if (newsize > size()) {
             reserve(newsize);
             for (; m_end < m_begin + newsize; ++m_end) {
@@ -772,27 +871,50 @@ public:
             }
         }
         else {
-            for (T* curr = m_begin + newsize; curr != m_end; ++curr) {
-                curr->~T();
-            }
+            destroy(m_begin + newsize, m_end);
             m_end = m_begin + newsize;
         }
     }
     void
-    swap(series_vector<T>& other)
+    swap(series_vector<T>& other) noexcept
     {
-        swap(m_begin, other.m_begin);
-        swap(m_end, other.m_end);
-        swap(m_max, other.m_max);
+        swap_storage(other);
     }
 
 private:
+    void
+    swap_storage(series_vector<T>& other) noexcept
+    {
+        std::swap(m_begin, other.m_begin);
+        std::swap(m_end, other.m_end);
+        std::swap(m_max, other.m_max);
+        std::swap(m_resource, other.m_resource);
+        std::swap(m_owner, other.m_owner);
+    }
+
+    // Copy borrowed elements into storage of our own with room for n
+    void
+    detach(size_t n)
+    {
+        series_vector<T> own(m_resource);
+        own.reserve(std::max(n, size()));
+        own.insert(own.cend(), cbegin(), cend());
+        swap_storage(own);
+    }
+
     void
     split_array(const_iterator pos, size_t count)
     {
         if (count == 0)
             return;
 
+        if constexpr (is_trivial) {
+            T* p = &*remove_const(pos);
+            std::memmove(p + count, p, (m_end - p) * sizeof(T));
+            m_end += count;
+            return;
+        }
+
         T* ricurr = m_end - 1;
         T* riend  = &*remove_const(pos) - 1;
         T* rocurr = ricurr + count;
@@ -853,11 +975,51 @@ private:
         return pow_2(n + 1);
     }
 
+    // The capacity to grow to when at least n elements are needed
+    size_t
+    grown_capacity(size_t n)
+    {
+        growth_policy policy = get_growth_policy();
+        if (policy == growth_policy::exact) {
+            return n;
+        }
+        if (policy == growth_policy::factor_1_5) {
+            return std::max(n, capacity() + capacity() / 2);
+        }
+        return pow_2(m_begin == nullptr ? std::max(n, DEFAULT_SIZE) : n);
+    }
+
+    T*
+    allocate(size_t n)
+    {
+        return static_cast<T*>(m_resource->allocate(n * sizeof(T), alignment));
+    }
+
+    T*
+    reallocate(T* p, size_t oldn, size_t n)
+    {
+        return static_cast<T*>(
+            m_resource->reallocate(p, oldn * sizeof(T), n * sizeof(T), alignment));
+    }
+
+    void
+    deallocate(T* p, size_t n) noexcept
+    {
+        if (p != nullptr) {
+            m_resource->deallocate(p, n * sizeof(T), alignment);
+        }
+    }
+
     void
     create_storage(size_t n)
     {
-        n       = next_pow_2(n);
-        m_begin = static_cast<T*>(malloc(n * sizeof(T)));
+        if (n == 0) {
+            return;
+        }
+        if (get_growth_policy() == growth_policy::power_of_two) {
+            n = next_pow_2(n);
+        }
+        m_begin = allocate(n);
         m_end   = m_begin;
         m_max   = m_begin + n;
     }
@@ -866,15 +1028,20 @@ private:
     void
     destroy(Iter begin, Iter end)
     {
+        if constexpr (is_trivial) {
+            return;
+        }
         auto curr = begin;
         for (; curr != end; ++curr) {
             curr->~T();
         }
     }
 
-    T* m_begin;
-    T* m_end;
-    T* m_max;
+    T* m_begin = nullptr;
+    T* m_end   = nullptr;
+    T* m_max   = nullptr;
+    memory_resource* m_resource;
+    std::shared_ptr<const void> m_owner;
 };
 
 
@@ -6,6 +6,8 @@
 #define INCLUDED_mainframe_detail_simd_h
 
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
 #if __AVX__
@@ -13,6 +15,7 @@
 #endif
 
 #include "mainframe/detail/base.hpp"
+#include "mainframe/missing.hpp"
 
 #if !defined(__AVX__) && !defined(__ARM_NEON)
 #ifdef _MSC_VER
@@ -52,19 +55,76 @@ stddev(const T* t, size_t num)
     return sqrt(sqdist / num);
 }
 
+// smi<T> holds missing in-band, so these skip the missing elements and
+// average over the rest
+template<typename T>
+double
+mean(const smi<T>* t, size_t num)
+{
+    double m = 0.0;
+    size_t n = 0;
+    for (const smi<T>* c = t; c != t + num; c++) {
+        if (c->has_value()) {
+            m += **c;
+            ++n;
+        }
+    }
+    return m / n;
+}
+
+template<typename T>
+double
+stddev(const smi<T>* t, size_t num)
+{
+    double m      = mean(t, num);
+    double sqdist = 0.0;
+    size_t n      = 0;
+    for (const smi<T>* c = t; c != t + num; c++) {
+        if (c->has_value()) {
+            double dist = **c - m;
+            sqdist += (dist * dist);
+            ++n;
+        }
+    }
+    return sqrt(sqdist / n);
+}
+
 #if defined(__AVX__)
+inline bool
+is_avx_aligned(const void* p)
+{
+    return reinterpret_cast<uintptr_t>(p) % 32 == 0;
+}
+
+// Number of leading elements to handle scalar-wise before t + n is 32-byte
+// aligned. series buffers are allocated aligned, so this is normally 0
+template<typename T>
+size_t
+avx_peel(const T* t, size_t num)
+{
+    size_t n = 0;
+    while (n < num && !is_avx_aligned(t + n)) {
+        ++n;
+    }
+    return n;
+}
+
 inline float
 mean(const float* t, size_t num)
 {
-    size_t i     = 0;
+    size_t i = avx_peel(t, num);
+    float m  = 0.0f;
+    for (size_t j = 0; j < i; ++j) {
+        m += t[j];
+    }
     __m256 accum = _mm256_setzero_ps();
     for (; i + 8 < num; i += 8) {
-        __m256 vals = _mm256_loadu_ps(t + i);
+        __m256 vals = _mm256_load_ps(t + i);
         accum       = _mm256_add_ps(accum, vals);
     }
     float ms[8];
     _mm256_storeu_ps(ms, accum);
-    float m = ms[0] + ms[1] + ms[2] + ms[3] + ms[4] + ms[5] + ms[6] + ms[7];
+    m += ms[0] + ms[1] + ms[2] + ms[3] + ms[4] + ms[5] + ms[6] + ms[7];
     for (; i < num; i += 1) {
         m += t[i];
     }
@@ -74,15 +134,19 @@ mean(const float* t, size_t num)
 inline double
 mean(const double* t, size_t num)
 {
-    size_t i      = 0;
+    size_t i = avx_peel(t, num);
+    double m = 0.0;
+    for (size_t j = 0; j < i; ++j) {
+        m += t[j];
+    }
     __m256d accum = _mm256_setzero_pd();
     for (; i + 4 < num; i += 4) {
-        __m256d vals = _mm256_loadu_pd(t + i);
+        __m256d vals = _mm256_load_pd(t + i);
         accum        = _mm256_add_pd(accum, vals);
     }
     double ms[4];
     _mm256_storeu_pd(ms, accum);
-    double m = ms[0] + ms[1] + ms[2] + ms[3];
+    m += ms[0] + ms[1] + ms[2] + ms[3];
     for (; i < num; i += 1) {
         m += t[i];
     }
@@ -121,6 +185,38 @@ correlate_pearson(const A* a, const B* b, size_t num)
     return corr;
 }
 
+// Pearson correlation over the rows where both a and b are present
+template<typename A, typename B>
+double
+correlate_pearson(const smi<A>* a, const smi<B>* b, size_t num)
+{
+    double asum = 0.0;
+    double bsum = 0.0;
+    size_t n    = 0;
+    for (size_t i = 0; i < num; ++i) {
+        if (a[i].has_value() && b[i].has_value()) {
+            asum += *a[i];
+            bsum += *b[i];
+            ++n;
+        }
+    }
+    double amean  = asum / n;
+    double bmean  = bsum / n;
+    double aaccum = 0.0;
+    double baccum = 0.0;
+    double cov    = 0.0;
+    for (size_t i = 0; i < num; ++i) {
+        if (a[i].has_value() && b[i].has_value()) {
+            double adiff = *a[i] - amean;
+            double bdiff = *b[i] - bmean;
+            aaccum += adiff * adiff;
+            baccum += bdiff * bdiff;
+            cov += adiff * bdiff;
+        }
+    }
+    return cov / std::sqrt(aaccum * baccum);
+}
+
 #if defined(__AVX__)
 
 inline double
@@ -134,10 +230,11 @@ correlate_pearson(const double* a, const double* b, size_t num)
     __m256d baccum = _mm256_setzero_pd();
     __m256d cov    = _mm256_setzero_pd();
     size_t k       = 0;
+    bool aligned   = is_avx_aligned(a) && is_avx_aligned(b);
     for (; k + 4 < num; k += 4) {
         __m256d xa, xb, adiff, bdiff, adiffsq, bdiffsq, abdiff;
-        xa      = _mm256_loadu_pd(a + k);
-        xb      = _mm256_loadu_pd(b + k);
+        xa      = aligned ? _mm256_load_pd(a + k) : _mm256_loadu_pd(a + k);
+        xb      = aligned ? _mm256_load_pd(b + k) : _mm256_loadu_pd(b + k);
         adiff   = _mm256_sub_pd(xa, amean);
         bdiff   = _mm256_sub_pd(xb, bmean);
         adiffsq = _mm256_mul_pd(adiff, adiff);
@@ -184,10 +281,11 @@ correlate_pearson(const float* a, const float* b, size_t num)
     __m256 baccum = _mm256_setzero_ps();
     __m256 cov    = _mm256_setzero_ps();
     size_t k      = 0;
+    bool aligned  = is_avx_aligned(a) && is_avx_aligned(b);
     for (; k + 8 < num; k += 8) {
         __m256 xa, xb, adiff, bdiff, adiffsq, bdiffsq, abdiff;
-        xa      = _mm256_loadu_ps(a + k);
-        xb      = _mm256_loadu_ps(b + k);
+        xa      = aligned ? _mm256_load_ps(a + k) : _mm256_loadu_ps(a + k);
+        xb      = aligned ? _mm256_load_ps(b + k) : _mm256_loadu_ps(b + k);
         adiff   = _mm256_sub_ps(xa, amean);
         bdiff   = _mm256_sub_ps(xb, bmean);
         adiffsq = _mm256_mul_ps(adiff, adiff);
@@ -226,9 +324,237 @@ correlate_pearson(const float* a, const float* b, size_t num)
     return corr;
 }
 
+// NaN-aware versions of the double kernels for smi<double>: an ordered
+// compare of each lane with itself masks out the NaN sentinels, so missing
+// elements add nothing to the sums or the counts
+static_assert(sizeof(smi<double>) == sizeof(double));
+
+inline double
+mean(const smi<double>* st, size_t num)
+{
+    const double* t = reinterpret_cast<const double*>(st);
+    size_t i        = avx_peel(t, num);
+    double m        = 0.0;
+    double n        = 0.0;
+    for (size_t j = 0; j < i; ++j) {
+        if (t[j] == t[j]) {
+            m += t[j];
+            n += 1.0;
+        }
+    }
+    __m256d ones  = _mm256_set1_pd(1.0);
+    __m256d accum = _mm256_setzero_pd();
+    __m256d count = _mm256_setzero_pd();
+    for (; i + 4 <= num; i += 4) {
+        __m256d vals    = _mm256_load_pd(t + i);
+        __m256d present = _mm256_cmp_pd(vals, vals, _CMP_ORD_Q);
+        accum           = _mm256_add_pd(accum, _mm256_and_pd(present, vals));
+        count           = _mm256_add_pd(count, _mm256_and_pd(present, ones));
+    }
+    double ms[4];
+    double ns[4];
+    _mm256_storeu_pd(ms, accum);
+    _mm256_storeu_pd(ns, count);
+    m += ms[0] + ms[1] + ms[2] + ms[3];
+    n += ns[0] + ns[1] + ns[2] + ns[3];
+    for (; i < num; i += 1) {
+        if (t[i] == t[i]) {
+            m += t[i];
+            n += 1.0;
+        }
+    }
+    return m / n;
+}
+
+inline double
+stddev(const smi<double>* st, size_t num)
+{
+    const double* t = reinterpret_cast<const double*>(st);
+    double sm       = mean(st, num);
+    size_t i        = avx_peel(t, num);
+    double sq       = 0.0;
+    double n        = 0.0;
+    for (size_t j = 0; j < i; ++j) {
+        if (t[j] == t[j]) {
+            sq += (t[j] - sm) * (t[j] - sm);
+            n += 1.0;
+        }
+    }
+    __m256d m     = _mm256_set1_pd(sm);
+    __m256d ones  = _mm256_set1_pd(1.0);
+    __m256d accum = _mm256_setzero_pd();
+    __m256d count = _mm256_setzero_pd();
+    for (; i + 4 <= num; i += 4) {
+        __m256d vals    = _mm256_load_pd(t + i);
+        __m256d present = _mm256_cmp_pd(vals, vals, _CMP_ORD_Q);
+        __m256d dist    = _mm256_and_pd(present, _mm256_sub_pd(vals, m));
+        accum           = _mm256_add_pd(accum, _mm256_mul_pd(dist, dist));
+        count           = _mm256_add_pd(count, _mm256_and_pd(present, ones));
+    }
+    double sqs[4];
+    double ns[4];
+    _mm256_storeu_pd(sqs, accum);
+    _mm256_storeu_pd(ns, count);
+    sq += sqs[0] + sqs[1] + sqs[2] + sqs[3];
+    n += ns[0] + ns[1] + ns[2] + ns[3];
+    for (; i < num; i += 1) {
+        if (t[i] == t[i]) {
+            sq += (t[i] - sm) * (t[i] - sm);
+            n += 1.0;
+        }
+    }
+    return std::sqrt(sq / n);
+}
+
+inline double
+correlate_pearson(const smi<double>* sa, const smi<double>* sb, size_t num)
+{
+    const double* a = reinterpret_cast<const double*>(sa);
+    const double* b = reinterpret_cast<const double*>(sb);
+    __m256d ones    = _mm256_set1_pd(1.0);
+
+    // first pass: means over the rows where both are present
+    __m256d asumv = _mm256_setzero_pd();
+    __m256d bsumv = _mm256_setzero_pd();
+    __m256d nv    = _mm256_setzero_pd();
+    size_t i      = 0;
+    for (; i + 4 <= num; i += 4) {
+        __m256d av   = _mm256_loadu_pd(a + i);
+        __m256d bv   = _mm256_loadu_pd(b + i);
+        __m256d both = _mm256_and_pd(
+            _mm256_cmp_pd(av, av, _CMP_ORD_Q), _mm256_cmp_pd(bv, bv, _CMP_ORD_Q));
+        asumv = _mm256_add_pd(asumv, _mm256_and_pd(both, av));
+        bsumv = _mm256_add_pd(bsumv, _mm256_and_pd(both, bv));
+        nv    = _mm256_add_pd(nv, _mm256_and_pd(both, ones));
+    }
+    double as[4], bs[4], ns[4];
+    _mm256_storeu_pd(as, asumv);
+    _mm256_storeu_pd(bs, bsumv);
+    _mm256_storeu_pd(ns, nv);
+    double asum = as[0] + as[1] + as[2] + as[3];
+    double bsum = bs[0] + bs[1] + bs[2] + bs[3];
+    double n    = ns[0] + ns[1] + ns[2] + ns[3];
+    for (size_t j = i; j < num; ++j) {
+        if (a[j] == a[j] && b[j] == b[j]) {
+            asum += a[j];
+            bsum += b[j];
+            n += 1.0;
+        }
+    }
+    double samean = asum / n;
+    double sbmean = bsum / n;
+
+    // second pass: covariance and variances around those means
+    __m256d amean  = _mm256_set1_pd(samean);
+    __m256d bmean  = _mm256_set1_pd(sbmean);
+    __m256d aaccum = _mm256_setzero_pd();
+    __m256d baccum = _mm256_setzero_pd();
+    __m256d cov    = _mm256_setzero_pd();
+    for (i = 0; i + 4 <= num; i += 4) {
+        __m256d av    = _mm256_loadu_pd(a + i);
+        __m256d bv    = _mm256_loadu_pd(b + i);
+        __m256d both  = _mm256_and_pd(
+            _mm256_cmp_pd(av, av, _CMP_ORD_Q), _mm256_cmp_pd(bv, bv, _CMP_ORD_Q));
+        __m256d adiff = _mm256_and_pd(both, _mm256_sub_pd(av, amean));
+        __m256d bdiff = _mm256_and_pd(both, _mm256_sub_pd(bv, bmean));
+        aaccum        = _mm256_add_pd(aaccum, _mm256_mul_pd(adiff, adiff));
+        baccum        = _mm256_add_pd(baccum, _mm256_mul_pd(bdiff, bdiff));
+        cov           = _mm256_add_pd(cov, _mm256_mul_pd(adiff, bdiff));
+    }
+    double aa[4], ba[4], cs[4];
+    _mm256_storeu_pd(aa, aaccum);
+    _mm256_storeu_pd(ba, baccum);
+    _mm256_storeu_pd(cs, cov);
+    double saaccum = aa[0] + aa[1] + aa[2] + aa[3];
+    double sbaccum = ba[0] + ba[1] + ba[2] + ba[3];
+    double scov    = cs[0] + cs[1] + cs[2] + cs[3];
+    for (; i < num; ++i) {
+        if (a[i] == a[i] && b[i] == b[i]) {
+            double adiff = a[i] - samean;
+            double bdiff = b[i] - sbmean;
+            saaccum += adiff * adiff;
+            sbaccum += bdiff * bdiff;
+            scov += adiff * bdiff;
+        }
+    }
+    return scov / std::sqrt(saaccum * sbaccum);
+}
+
 #elif defined(__ARM_NEON)
 #endif
 
+// Copy the src[j] whose bit j is set in bits to dest, in order, and return
+// how many were copied. src needs only to be valid up to the highest set
+// bit. T must be trivially copyable
+template<typename T>
+size_t
+compress_word(const T* src, uint64_t bits, T* dest)
+{
+    if (bits == ~uint64_t{ 0 }) {
+        std::memcpy(dest, src, 64 * sizeof(T));
+        return 64;
+    }
+#if defined(__AVX512F__)
+    if constexpr (sizeof(T) == 8) {
+        size_t k = 0;
+        for (int c = 0; c < 8; ++c) {
+            __mmask8 m = static_cast<__mmask8>(bits >> (8 * c));
+            if (m != 0) {
+                __m512i v = _mm512_maskz_loadu_epi64(m, src + 8 * c);
+                _mm512_mask_compressstoreu_epi64(dest + k, m, v);
+                k += popcount64(m);
+            }
+        }
+        return k;
+    }
+    if constexpr (sizeof(T) == 4) {
+        size_t k = 0;
+        for (int c = 0; c < 4; ++c) {
+            __mmask16 m = static_cast<__mmask16>(bits >> (16 * c));
+            if (m != 0) {
+                __m512i v = _mm512_maskz_loadu_epi32(m, src + 16 * c);
+                _mm512_mask_compressstoreu_epi32(dest + k, m, v);
+                k += popcount64(m);
+            }
+        }
+        return k;
+    }
+#endif
+    size_t count = popcount64(bits);
+    if (count >= 16) {
+        // Dense words copy every row up to the last selected one and only
+        // advance past the selected ones, which needs no branches
+        size_t last = 63 - clz64(bits);
+        size_t k    = 0;
+        for (size_t j = 0; j <= last; ++j) {
+            dest[k] = src[j];
+            k += (bits >> j) & 1;
+        }
+    }
+    else {
+        size_t k = 0;
+        while (bits != 0) {
+            dest[k++] = src[ctz64(bits)];
+            bits &= bits - 1;
+        }
+    }
+    return count;
+}
+
+// Copy the src[i] whose bit is set in the mask words covering num rows to
+// dest, which must have room for all of them
+template<typename T>
+void
+compress(const T* src, const uint64_t* words, size_t num, T* dest)
+{
+    size_t k = 0;
+    for (size_t w = 0; w * 64 < num; ++w) {
+        if (words[w] != 0) {
+            k += compress_word(src + w * 64, words[w], dest + k);
+        }
+    }
+}
+
 } // namespace mf::detail
 
 #endif // INCLUDED_mainframe_detail_simd_h
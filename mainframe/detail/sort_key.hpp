@@ -0,0 +1,396 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_detail_sort_key_h
+#define INCLUDED_mainframe_detail_sort_key_h
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "mainframe/detail/base.hpp"
+#include "mainframe/detail/parallel.hpp"
+#include "mainframe/detail/radix_sort.hpp"
+#include "mainframe/missing.hpp"
+
+namespace mf::detail
+{
+
+// The number of leading bytes of a string kept in its key
+constexpr size_t sort_key_string_prefix = 15;
+
+// Below this many rows, comparing the columns directly is as fast as
+// encoding keys first
+constexpr size_t sort_key_min_rows = 1024;
+
+// key_encoder<T> writes a T as `width` bytes that compare with memcmp() in
+// the order of T's operator<. An encoding that keeps only part of some
+// values isn't `exact`: two keys that tie in memcmp() may still belong to
+// different values if truncated() is true of them, and then the values
+// have to be compared themselves.
+template<typename T, typename = void>
+struct key_encoder : std::false_type
+{};
+
+// Anything with a radix key, big-endian so that the most significant byte
+// is compared first
+template<typename T>
+struct key_encoder<T, std::enable_if_t<radix_key<T>::value>> : std::true_type
+{
+    static constexpr size_t width = sizeof(typename radix_key<T>::type);
+    static constexpr bool exact   = true;
+
+    static void
+    encode(const T& t, uint8_t* out)
+    {
+        auto k = radix_key<T>::encode(t);
+        for (size_t b = 0; b < width; ++b) {
+            out[b] = static_cast<uint8_t>(k >> (8 * (width - 1 - b)));
+        }
+    }
+
+    static bool
+    truncated(const uint8_t*)
+    {
+        return false;
+    }
+};
+
+template<>
+struct key_encoder<bool> : std::true_type
+{
+    static constexpr size_t width = 1;
+    static constexpr bool exact   = true;
+
+    static void
+    encode(bool t, uint8_t* out)
+    {
+        out[0] = t ? 1 : 0;
+    }
+
+    static bool
+    truncated(const uint8_t*)
+    {
+        return false;
+    }
+};
+
+// The first sort_key_string_prefix bytes, zero padded, then the length,
+// capped at one more than the prefix. Strings that fit in the prefix are
+// encoded exactly, shorter ones sorting before longer ones they're a
+// prefix of; two longer strings with the same prefix tie.
+template<>
+struct key_encoder<std::string> : std::true_type
+{
+    static constexpr size_t width = sort_key_string_prefix + 1;
+    static constexpr bool exact   = false;
+
+    static void
+    encode(const std::string& s, uint8_t* out)
+    {
+        size_t n = std::min(s.size(), sort_key_string_prefix);
+        std::memcpy(out, s.data(), n);
+        std::memset(out + n, 0, sort_key_string_prefix - n);
+        out[sort_key_string_prefix] =
+            static_cast<uint8_t>(std::min(s.size(), sort_key_string_prefix + 1));
+    }
+
+    static bool
+    truncated(const uint8_t* key)
+    {
+        return key[sort_key_string_prefix] > sort_key_string_prefix;
+    }
+};
+
+// A flag byte, 0 for missing and 1 otherwise, then the value. Missing
+// values are zeroed so that they all tie, and they sort first, as they do
+// with operator<.
+template<typename O>
+struct optional_key_encoder : std::true_type
+{
+    using value_encoder = key_encoder<typename O::value_type>;
+
+    static constexpr size_t width = 1 + value_encoder::width;
+    static constexpr bool exact   = value_encoder::exact;
+
+    static void
+    encode(const O& o, uint8_t* out)
+    {
+        if (o.has_value()) {
+            out[0] = 1;
+            value_encoder::encode(*o, out + 1);
+        }
+        else {
+            std::memset(out, 0, width);
+        }
+    }
+
+    static bool
+    truncated(const uint8_t* key)
+    {
+        return key[0] != 0 && value_encoder::truncated(key + 1);
+    }
+};
+
+template<typename T>
+struct key_encoder<mi<T>, std::enable_if_t<key_encoder<T>::value>> : optional_key_encoder<mi<T>>
+{};
+
+template<typename T>
+struct key_encoder<smi<T>, std::enable_if_t<key_encoder<T>::value>> : optional_key_encoder<smi<T>>
+{};
+
+// Whether rows can be sorted on normalized keys of columns of these types
+template<typename... Ts>
+struct key_sortable : std::bool_constant<(key_encoder<Ts>::value && ...)>
+{};
+
+// Three-way comparison of the values of row ra of columns a with row rb of
+// columns b
+template<size_t Ind = 0, typename... Ts>
+int
+compare_values(
+    const std::tuple<const Ts*...>& a, size_t ra, const std::tuple<const Ts*...>& b, size_t rb)
+{
+    const auto& x = std::get<Ind>(a)[ra];
+    const auto& y = std::get<Ind>(b)[rb];
+    if (x < y) {
+        return -1;
+    }
+    if (y < x) {
+        return 1;
+    }
+    if constexpr (Ind + 1 < sizeof...(Ts)) {
+        return compare_values<Ind + 1>(a, ra, b, rb);
+    }
+    else {
+        return 0;
+    }
+}
+
+// The 8 bytes at p as a big-endian integer
+inline uint64_t
+load_be64(const uint8_t* p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return v;
+#elif defined(_MSC_VER)
+    return _byteswap_uint64(v);
+#else
+    return __builtin_bswap64(v);
+#endif
+}
+
+// memcmp() of N bytes, N known at compile time. Most keys are a few
+// words, so comparing a word at a time inline beats calling memcmp().
+template<size_t N>
+int
+compare_bytes(const uint8_t* a, const uint8_t* b)
+{
+    size_t i = 0;
+    for (; i + 8 <= N; i += 8) {
+        uint64_t x = load_be64(a + i);
+        uint64_t y = load_be64(b + i);
+        if (x != y) {
+            return x < y ? -1 : 1;
+        }
+    }
+    for (; i < N; ++i) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// Where each column goes in the key of a row, and how keys compare
+template<typename... Ts>
+struct key_layout
+{
+    static constexpr size_t width = (key_encoder<Ts>::width + ...);
+    static constexpr bool exact   = (key_encoder<Ts>::exact && ...);
+
+    static constexpr std::array<size_t, sizeof...(Ts)>
+    offsets()
+    {
+        std::array<size_t, sizeof...(Ts)> out{};
+        size_t widths[] = { key_encoder<Ts>::width... };
+        size_t sum      = 0;
+        for (size_t i = 0; i < sizeof...(Ts); ++i) {
+            out[i] = sum;
+            sum += widths[i];
+        }
+        return out;
+    }
+
+    static void
+    encode(const std::tuple<const Ts*...>& cols, size_t row, uint8_t* out)
+    {
+        encode_impl(cols, row, out, std::index_sequence_for<Ts...>{});
+    }
+
+    // Three-way comparison of two keys. Runs of exact columns are compared
+    // in one go; a tie on a truncated column is settled by tie_break(),
+    // which compares the values.
+    template<typename TieBreak>
+    static int
+    compare(const uint8_t* a, const uint8_t* b, TieBreak tie_break)
+    {
+        if constexpr (exact) {
+            return compare_bytes<width>(a, b);
+        }
+        else {
+            return compare_from<0, 0>(a, b, tie_break);
+        }
+    }
+
+private:
+    template<size_t... Is>
+    static void
+    encode_impl(
+        const std::tuple<const Ts*...>& cols, size_t row, uint8_t* out, std::index_sequence<Is...>)
+    {
+        (key_encoder<Ts>::encode(std::get<Is>(cols)[row], out + offsets()[Is]), ...);
+    }
+
+    template<size_t Ind, size_t Begin, typename TieBreak>
+    static int
+    compare_from(const uint8_t* a, const uint8_t* b, TieBreak tie_break)
+    {
+        using encoder        = key_encoder<typename pack_element<Ind, Ts...>::type>;
+        constexpr size_t off = offsets()[Ind];
+        constexpr size_t end = off + encoder::width;
+        if constexpr (encoder::exact && Ind + 1 < sizeof...(Ts)) {
+            return compare_from<Ind + 1, Begin>(a, b, tie_break);
+        }
+        else {
+            int c = compare_bytes<end - Begin>(a + Begin, b + Begin);
+            if (c != 0) {
+                return c;
+            }
+            if constexpr (!encoder::exact) {
+                if (encoder::truncated(a + off)) {
+                    return tie_break();
+                }
+            }
+            if constexpr (Ind + 1 < sizeof...(Ts)) {
+                return compare_from<Ind + 1, end>(a, b, tie_break);
+            }
+            else {
+                return 0;
+            }
+        }
+    }
+};
+
+// The first 8 bytes of a key of the given width as a big-endian integer,
+// zero padded if the key is shorter
+template<size_t Width>
+uint64_t
+key_prefix(const uint8_t* key)
+{
+    if constexpr (Width >= 8) {
+        return load_be64(key);
+    }
+    else {
+        uint8_t padded[8] = {};
+        std::memcpy(padded, key, Width);
+        return load_be64(padded);
+    }
+}
+
+// Stable-sort the row indices in order by the columns, descending if
+// Reverse, using a key per row written by fill(row, out). Each key is
+// copied next to its row index so the sort reads it without chasing the
+// columns. The keys are radix sorted on their first 8 bytes, and only
+// runs that tie on those are then sorted by comparing whole keys.
+template<bool Reverse, typename... Ts, typename Fill>
+void
+sort_on_keys(
+    std::vector<size_t>& order, unsigned threads, const std::tuple<const Ts*...>& cols, Fill fill)
+{
+    using layout = key_layout<Ts...>;
+    struct entry
+    {
+        std::array<uint8_t, layout::width> key;
+        size_t row;
+    };
+
+    size_t n = order.size();
+    std::vector<entry> a(n);
+    std::vector<entry> tmp(n);
+    parallel_for(threads, n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            fill(order[i], a[i].key.data());
+            a[i].row = order[i];
+        }
+    });
+
+    auto less = [&](const entry& l, const entry& r) {
+        const entry& x = Reverse ? r : l;
+        const entry& y = Reverse ? l : r;
+        return layout::compare(x.key.data(), y.key.data(), [&] {
+            return compare_values(cols, x.row, cols, y.row);
+        }) < 0;
+    };
+    auto prefix = [](const entry& e) {
+        uint64_t p = key_prefix<layout::width>(e.key.data());
+        return Reverse ? ~p : p;
+    };
+    auto sort_chunk = [&](entry* first, entry* last, entry* scratch) {
+        size_t len = static_cast<size_t>(last - first);
+        radix_sort(first, scratch, len, prefix);
+        if constexpr (layout::width > 8 || !layout::exact) {
+            for (size_t i = 0; i < len;) {
+                size_t j   = i + 1;
+                uint64_t p = prefix(first[i]);
+                while (j < len && prefix(first[j]) == p) {
+                    ++j;
+                }
+                if (j - i > 1) {
+                    std::stable_sort(first + i, first + j, less);
+                }
+                i = j;
+            }
+        }
+    };
+    if (threads > 1) {
+        parallel_merge_sort(a.data(), tmp.data(), n, threads, less, sort_chunk);
+    }
+    else {
+        sort_chunk(a.data(), a.data() + n, tmp.data());
+    }
+
+    parallel_for(threads, n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            order[i] = a[i].row;
+        }
+    });
+}
+
+// Stable-sort the row indices in order by the normalized keys of cols,
+// descending if Reverse
+template<bool Reverse, typename... Ts>
+void
+key_argsort(std::vector<size_t>& order, unsigned threads, const Ts*... cols)
+{
+    static_assert(key_sortable<Ts...>::value);
+    auto tcols = std::make_tuple(cols...);
+    sort_on_keys<Reverse>(order, threads, tcols,
+        [&](size_t row, uint8_t* out) { key_layout<Ts...>::encode(tcols, row, out); });
+}
+
+} // namespace mf::detail
+
+
+#endif // INCLUDED_mainframe_detail_sort_key_h
@@ -46,7 +46,11 @@ public:
     useries(const series<T>& s)
         : m_name(s.m_name)
         , m_data(std::dynamic_pointer_cast<iseries_vector>(s.m_sharedvec))
-    {}
+    {
+        if (!m_data) {
+            m_data = std::make_shared<series_vector<T>>();
+        }
+    }
 
     template<typename T>
     operator series<T>() const
@@ -26,7 +26,9 @@
 #include "mainframe/detail/uframe.hpp"
 #include "mainframe/expression.hpp"
 #include "mainframe/frame_iterator.hpp"
+#include "mainframe/mask.hpp"
 #include "mainframe/missing.hpp"
+#include "mainframe/parallel.hpp"
 #include "mainframe/series.hpp"
 
 namespace mf
@@ -38,6 +40,12 @@ struct index_defn;
 template<typename IndexDefn, typename... Ts>
 class group;
 
+template<typename... Ts>
+class frame_view;
+
+template<typename... Ts>
+class sort_keys;
+
 ///
 /// dataframe class
 ///
@@ -86,6 +94,26 @@ public:
     frame&
     operator=(frame&&) = default;
 
+    /// Create an empty frame whose columns allocate from resource rather
+    /// than the default memory resource
+    ///
+    ///     my_pool_resource pool;
+    ///     frame<year_month_day, double, double> f(&pool);
+    ///
+    explicit frame(memory_resource* resource);
+
+    /// Create a frame from one existing series per column. The columns
+    /// share the series' buffers, so a frame can be built over borrowed or
+    /// adopted buffers without copying them. Throws std::logic_error if the
+    /// series aren't all the same length.
+    ///
+    ///     series<int64_t> ids(id_buf, n, free_ids);
+    ///     series<double> prices(price_buf, n, free_prices);
+    ///     frame<int64_t, double> f(ids, prices);
+    ///
+    template<size_t N = sizeof...(Ts), std::enable_if_t<(N > 1), bool> = true>
+    explicit frame(const series<Ts>&... columns);
+
     /// Requests a row iterator pointing to the first row of the frame. Note
     /// that this is a nonconst-iterator which means that any underlying series
     /// with a reference count greater than 1 will be copied first.
@@ -289,6 +317,41 @@ public:
     frame<Ts..., T>
     append_series(const series<T>& s) const;
 
+    /// Append whole columns' worth of rows at once, one range per column.
+    /// Each range can be anything std::begin()/std::end() work on - a
+    /// std::vector, std::array, C array or series - and all of them must be
+    /// the same length. Every column is reserved once and filled in a single
+    /// pass, which is much cheaper than a push_back() per row.
+    ///
+    ///     std::vector<year_month> months{ 2022_y/1, 2022_y/2, 2022_y/3 };
+    ///     std::vector<int> lengths{ 1, 2, 3 };
+    ///     double depths[] = { 1.1, 2.2, 3.3 };
+    ///
+    ///     frame<year_month, int, double> f;
+    ///     f.append_columns(months, lengths, depths);
+    ///
+    template<typename... Cs>
+    void
+    append_columns(const Cs&... cols);
+
+    /// The order that sort() would put the rows in: the i'th element is
+    /// the index of the row that would end up at i. Only the key columns
+    /// are read, and rows with equal keys keep their relative order. Pass
+    /// the result to gather() to apply the same order to this frame or to
+    /// any other frame with the same rows.
+    ///
+    ///     auto order  = trades.argsort(_2, _0);
+    ///     auto sorted = trades.gather(order);
+    ///     auto fills  = trade_fills.gather(order);
+    ///
+    template<size_t... Inds>
+    std::vector<size_t>
+    argsort(columnindex<Inds>... ci) const;
+
+    template<size_t... Inds>
+    std::vector<size_t>
+    argsort(parallel p, columnindex<Inds>...) const;
+
     /// Remove all rows/data from the dataframe
     ///
     void
@@ -378,6 +441,23 @@ public:
     frame<Ts...>
     fill_backward() const;
 
+    /// The rows whose bit is set in m, which must have one bit per row.
+    /// Each column is sized once and then gathered a mask word at a time,
+    /// copying runs of selected rows whole and compacting the rest without
+    /// branching (with AVX-512 compress stores where available).
+    ///
+    ///     mask hot = f.make_mask(_1 > 30.0);
+    ///     auto f2  = f.filter(hot);
+    ///
+    frame<Ts...>
+    filter(const mask& m) const;
+
+    /// A frame made of the rows at the given indices, in that order, e.g.
+    /// a permutation from argsort(). Each column is gathered in one pass.
+    /// Throws std::out_of_range if an index is not less than size().
+    frame<Ts...>
+    gather(const std::vector<size_t>& rows) const;
+
     template<size_t... Idx>
     group<index_defn<Idx...>, Ts...>
     groupby(columnindex<Idx>...) const;
@@ -395,13 +475,34 @@ public:
     iterator
     insert(iterator pos, size_t count, const Ts&... ts);
 
+    /// Evaluate ex once per row and record the results in a @ref mask,
+    /// which can then be combined with other masks and passed to filter()
+    /// without evaluating ex again. Comparisons of a column with a constant
+    /// or another column, and &&, || and ! of these, are evaluated a column
+    /// at a time in tight loops; anything else is evaluated row by row.
+    template<typename Ex>
+    std::enable_if_t<is_expression<Ex>::value, mask>
+    make_mask(Ex ex) const;
+
     template<typename T, typename Ex>
     series<T>
     make_series(const std::string& column_name, Ex expr) const;
 
+    /// The given columns normalized into memcmp()-comparable @ref
+    /// sort_keys, to sort by, merge-join on or search in sorted order
+    template<size_t... Inds>
+    sort_keys<typename detail::pack_element<Inds, Ts...>::type...>
+    make_sort_keys(columnindex<Inds>...) const;
+
     template<size_t Ind>
     double mean(columnindex<Ind>) const;
 
+    /// The bytes held by all the columns together; see @ref memory_stats.
+    /// Columns shared with another frame, e.g. after a copy or slice(),
+    /// show up in shared_bytes.
+    memory_stats
+    memory_usage() const;
+
     template<size_t Ind>
     using pack_elem_pair =
         std::pair<typename pack_element<Ind, Ts...>::type, typename detail::pack_element<Ind, Ts...>::type>;
@@ -649,20 +750,33 @@ public:
     frame<Ts...>
     reversed() const;
 
+    /// Sort the rows in descending order of the given columns; see sort()
+    template<size_t... Inds>
+    void
+    reverse_sort(columnindex<Inds>... ci);
+
     template<size_t... Inds>
     void
-    reverse_sort(columnindex<Inds>...);
+    reverse_sort(parallel p, columnindex<Inds>...);
 
     template<size_t... Inds>
     frame<Ts...>
     reverse_sorted(columnindex<Inds>... ci) const;
 
+    template<size_t... Inds>
+    frame<Ts...>
+    reverse_sorted(parallel p, columnindex<Inds>...) const;
+
     _row_proxy<false, Ts...>
     row(size_t ind);
 
     _row_proxy<true, Ts...>
     row(size_t ind) const;
 
+    /// The rows for which ex is true: the same as filter(make_mask(ex))
+    ///
+    ///     auto warm = f.rows(_1 > 20.0 && _2 == false);
+    ///
     template<typename Ex>
     std::enable_if_t<is_expression<Ex>::value, frame<Ts...>>
     rows(Ex ex) const;
@@ -677,28 +791,99 @@ public:
     void
     set_column_names(const Us&... colnames);
 
+    /// Call shrink_to_fit() on every column, so that each holds no more
+    /// than size() elements
+    ///
+    ///     frame<year_month_day, double> f;
+    ///     ... // many push_back()s
+    ///     f.shrink_to_fit();
+    ///
+    void
+    shrink_to_fit();
+
     size_t
     size() const;
 
+    /// A frame of rows [begin, end) whose columns share this frame's
+    /// buffers instead of copying them. Like any other copy, the slice is
+    /// only materialized when it is written to, and it stays valid if this
+    /// frame is modified or destroyed.
+    ///
+    ///     frame<year_month_day, double, bool> f;
+    ///     ... // one row per minute
+    ///     for (size_t b = 0; b < f.size(); b += 1440) {
+    ///         auto day = f.slice(b, std::min(b + 1440, f.size()));
+    ///         process(day);
+    ///     }
+    ///
+    frame<Ts...>
+    slice(size_t begin, size_t end) const;
+
+    /// Sort the rows in ascending order of the given columns. The order is
+    /// worked out from the key columns alone, as argsort() does, and then
+    /// every column is rearranged once, so the cost of the payload columns
+    /// doesn't grow with the number of comparisons. Rows with equal keys
+    /// keep their relative order.
+    ///
+    ///     f.sort(_2, _0);     // by column 2, then column 0
+    ///
+    /// When every key column is an integer, floating point, std::chrono or
+    /// calendar date type and the keys add up to at most 64 bits, large
+    /// frames are radix sorted rather than compared row by row. Other
+    /// numeric, date, string and mi<> keys are sorted with memcmp() on
+    /// normalized @ref sort_keys. Pass a @ref parallel first to sort on
+    /// several threads.
+    ///
+    template<size_t... Inds>
+    void
+    sort(columnindex<Inds>... ci);
+
     template<size_t... Inds>
     void
-    sort(columnindex<Inds>...);
+    sort(parallel p, columnindex<Inds>...);
 
     template<size_t... Inds>
     frame<Ts...>
     sorted(columnindex<Inds>... ci) const;
 
+    template<size_t... Inds>
+    frame<Ts...>
+    sorted(parallel p, columnindex<Inds>...) const;
+
     template<size_t Ind>
     double stddev(columnindex<Ind>) const;
 
     std::vector<std::vector<std::string>>
     to_string() const;
 
+    /// The rows for which ex is true, as a @ref frame_view over this frame
+    /// rather than a copy of them. Statistics, sorting and groupby can then
+    /// run on the selected rows without gathering every column first.
+    ///
+    ///     double avg = f.where(_2 == false).mean(_1);
+    ///     auto hot   = f.where(_1 > 30.0).sorted(_1).materialize();
+    ///
+    template<typename Ex>
+    std::enable_if_t<is_expression<Ex>::value, frame_view<Ts...>>
+    where(Ex ex) const;
+
 private:
     template<size_t Ind, size_t... Inds>
     void
     allow_missing_impl(uframe& uf, columnindex<Inds>... cols) const;
 
+    template<size_t Ind, typename C, typename... Cs>
+    void
+    append_columns_impl(const C& col, const Cs&... cols);
+
+    template<size_t Ind>
+    void
+    apply_order_impl(const std::vector<size_t>& order, unsigned threads);
+
+    template<bool Reverse, size_t... Inds>
+    std::vector<size_t>
+    argsort_impl(unsigned threads) const;
+
     template<size_t Ind, typename U, typename... Us>
     void
     allow_missing_impl(uframe& uf) const;
@@ -743,6 +928,14 @@ private:
     bool
     eq_impl(const frame<Ts...>& other) const;
 
+    template<size_t Ind>
+    void
+    filter_impl(frame<Ts...>& out, const mask& m, size_t count) const;
+
+    template<size_t Ind>
+    void
+    gather_impl(frame<Ts...>& out, const std::vector<size_t>& rows, unsigned threads) const;
+
     template<size_t Ind, typename U, typename... Us>
     void
     insert_impl(std::tuple<Ts*...>& ptrs, iterator pos, size_t count, const U& u, const Us&... us);
@@ -751,6 +944,28 @@ private:
     void
     insert_impl(std::tuple<Ts*...>& ptrs, iterator pos, const_iterator first, const_iterator last);
 
+    template<typename Ex>
+    void
+    mask_words_impl(const Ex& ex, size_t first, size_t num, uint64_t* words) const;
+
+    template<typename Op, typename L, typename R>
+    void
+    mask_words_impl(
+        const binary_expr<Op, L, R>& ex, size_t first, size_t num, uint64_t* words) const;
+
+    template<typename T>
+    void
+    mask_words_impl(
+        const unary_expr<expr_op::NOT, T>& ex, size_t first, size_t num, uint64_t* words) const;
+
+    template<typename Ex>
+    void
+    mask_words_rows(const Ex& ex, size_t first, size_t num, uint64_t* words) const;
+
+    template<size_t Ind>
+    void
+    memory_usage_impl(memory_stats& out) const;
+
     template<size_t Ind>
     void
     pop_back_impl();
@@ -799,10 +1014,18 @@ private:
     void
     set_column_names_impl(const U& colname, const Us&... colnames);
 
+    template<size_t Ind>
+    void
+    shrink_to_fit_impl();
+
     template<size_t Ind, typename U, typename... Us>
     size_t
     size_impl_with_check() const;
 
+    template<size_t Ind>
+    void
+    slice_impl(frame<Ts...>& out, size_t begin, size_t end) const;
+
     template<size_t Ind, typename U, typename... Us>
     void
     to_string_impl(std::vector<std::vector<std::string>>& strs) const;
@@ -815,6 +1038,8 @@ private:
     friend std::ostream&
     operator<<(std::ostream&, const frame<Us...>&);
     friend class uframe;
+    template<typename... Us>
+    friend class frame_builder;
 
     std::tuple<series<Ts>...> m_columns;
 };
@@ -0,0 +1,160 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_frame_builder_h
+#define INCLUDED_mainframe_frame_builder_h
+
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "mainframe/frame.hpp"
+
+namespace mf
+{
+
+///
+/// frame_builder class
+///
+/// Row-at-a-time ingestion into a @ref frame without paying for a
+/// push_back() into every column on every row. Rows are staged in small
+/// per-column buffers sized to stay in cache, then flushed into the frame
+/// one column at a time with a single reserve per flush. Arguments are
+/// perfectly forwarded, so strings and other heavy types are moved rather
+/// than copied.
+///
+///     frame<year_month_day, std::string, double> f;
+///     {
+///         frame_builder b(f);
+///         for (auto& tick : feed) {
+///             b.push_back(tick.date, std::move(tick.symbol), tick.price);
+///         }
+///     } // remaining rows are flushed here
+///
+/// The frame must outlive the builder, and rows aren't visible in the frame
+/// until they're flushed. A flush that throws in the destructor drops the
+/// pending rows, so call flush() first if that needs handling.
+///
+template<typename... Ts>
+class frame_builder
+{
+public:
+    /// Rows staged before an automatic flush when none is given. Aims for
+    /// the staging buffers to fit in a typical 256KiB L2 cache
+    static constexpr size_t default_batch_rows =
+        std::max<size_t>(64, (256 * 1024) / (sizeof(Ts) + ... + 0));
+
+    explicit frame_builder(frame<Ts...>& f, size_t batch_rows = default_batch_rows)
+        : m_frame(f)
+        , m_batch_rows(std::max<size_t>(batch_rows, 1))
+    {
+        reserve_impl<0>();
+    }
+
+    frame_builder(const frame_builder&) = delete;
+    frame_builder&
+    operator=(const frame_builder&) = delete;
+
+    ~frame_builder()
+    {
+        try {
+            flush();
+        }
+        catch (...) {
+        }
+    }
+
+    /// Stage one row. Takes exactly one argument per column. If a value
+    /// throws as it's staged, the row isn't staged at all
+    template<typename... Us>
+    void
+    push_back(Us&&... args)
+    {
+        static_assert(sizeof...(Us) == sizeof...(Ts), "push_back() needs one value per column");
+        push_back_impl<0>(std::forward<Us>(args)...);
+        if (++m_pending == m_batch_rows) {
+            flush();
+        }
+    }
+
+    /// Move all staged rows into the frame
+    void
+    flush()
+    {
+        if (m_pending == 0) {
+            return;
+        }
+        m_frame.reserve(m_frame.size() + m_pending);
+        flush_impl<0>();
+        m_pending = 0;
+    }
+
+    /// Number of rows staged but not yet flushed
+    size_t
+    pending() const
+    {
+        return m_pending;
+    }
+
+private:
+    template<size_t Ind, typename U, typename... Us>
+    void
+    push_back_impl(U&& arg, Us&&... args)
+    {
+        auto& buf = std::get<Ind>(m_buffers);
+        buf.emplace_back(std::forward<U>(arg));
+        if constexpr (Ind + 1 < sizeof...(Ts)) {
+            // Unstage this column's value if a later one throws, so that the
+            // buffers stay the same length
+            try {
+                push_back_impl<Ind + 1>(std::forward<Us>(args)...);
+            }
+            catch (...) {
+                buf.pop_back();
+                throw;
+            }
+        }
+    }
+
+    template<size_t Ind>
+    void
+    flush_impl()
+    {
+        auto& buf = std::get<Ind>(m_buffers);
+        auto& s   = std::get<Ind>(m_frame.m_columns);
+        s.insert(s.cend(), std::make_move_iterator(buf.begin()), std::make_move_iterator(buf.end()));
+        buf.clear();
+        if constexpr (Ind + 1 < sizeof...(Ts)) {
+            flush_impl<Ind + 1>();
+        }
+    }
+
+    template<size_t Ind>
+    void
+    reserve_impl()
+    {
+        std::get<Ind>(m_buffers).reserve(m_batch_rows);
+        if constexpr (Ind + 1 < sizeof...(Ts)) {
+            reserve_impl<Ind + 1>();
+        }
+    }
+
+    frame<Ts...>& m_frame;
+    size_t m_batch_rows;
+    size_t m_pending = 0;
+    std::tuple<std::vector<Ts>...> m_buffers;
+};
+
+template<typename... Ts>
+frame_builder(frame<Ts...>&) -> frame_builder<Ts...>;
+
+template<typename... Ts>
+frame_builder(frame<Ts...>&, size_t) -> frame_builder<Ts...>;
+
+} // namespace mf
+
+
+#endif // INCLUDED_mainframe_frame_builder_h
@@ -0,0 +1,481 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_frame_view_h
+#define INCLUDED_mainframe_frame_view_h
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "mainframe/frame.hpp"
+#include "mainframe/group.hpp"
+
+namespace mf
+{
+
+///
+/// An iterator over the selected rows of a @ref frame_view, in selection
+/// order. It dereferences to the same row proxies as a frame's
+/// const_iterator.
+///
+template<typename... Ts>
+class frame_view_iterator
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = frame_row<Ts...>;
+    using difference_type   = ptrdiff_t;
+    using reference         = const _row_proxy<true, Ts...>&;
+    using pointer           = const _row_proxy<true, Ts...>*;
+
+    frame_view_iterator(const_frame_iterator<Ts...> base, const size_t* pos)
+        : m_base(base)
+        , m_pos(pos)
+        , m_row(base)
+    {}
+
+    frame_view_iterator&
+    operator++()
+    {
+        ++m_pos;
+        return *this;
+    }
+    frame_view_iterator
+    operator++(int)
+    {
+        frame_view_iterator out{ *this };
+        ++m_pos;
+        return out;
+    }
+    frame_view_iterator&
+    operator--()
+    {
+        --m_pos;
+        return *this;
+    }
+    frame_view_iterator
+    operator--(int)
+    {
+        frame_view_iterator out{ *this };
+        --m_pos;
+        return out;
+    }
+    frame_view_iterator&
+    operator+=(ptrdiff_t n)
+    {
+        m_pos += n;
+        return *this;
+    }
+    frame_view_iterator&
+    operator-=(ptrdiff_t n)
+    {
+        m_pos -= n;
+        return *this;
+    }
+
+    frame_view_iterator
+    operator+(ptrdiff_t n) const
+    {
+        return frame_view_iterator{ m_base, m_pos + n };
+    }
+
+    frame_view_iterator
+    operator-(ptrdiff_t n) const
+    {
+        return frame_view_iterator{ m_base, m_pos - n };
+    }
+
+    ptrdiff_t
+    operator-(const frame_view_iterator& other) const
+    {
+        return m_pos - other.m_pos;
+    }
+
+    reference
+    operator*() const
+    {
+        m_row = m_base + static_cast<ptrdiff_t>(*m_pos);
+        return *m_row;
+    }
+
+    pointer
+    operator->() const
+    {
+        return &operator*();
+    }
+
+    /// The index of the current row in the frame the view was made from
+    size_t
+    source_row() const
+    {
+        return *m_pos;
+    }
+
+    bool
+    operator==(const frame_view_iterator& other) const
+    {
+        return m_pos == other.m_pos;
+    }
+
+    bool
+    operator!=(const frame_view_iterator& other) const
+    {
+        return m_pos != other.m_pos;
+    }
+
+    bool
+    operator<(const frame_view_iterator& other) const
+    {
+        return m_pos < other.m_pos;
+    }
+
+    bool
+    operator>(const frame_view_iterator& other) const
+    {
+        return m_pos > other.m_pos;
+    }
+
+    bool
+    operator<=(const frame_view_iterator& other) const
+    {
+        return m_pos <= other.m_pos;
+    }
+
+    bool
+    operator>=(const frame_view_iterator& other) const
+    {
+        return m_pos >= other.m_pos;
+    }
+
+private:
+    const_frame_iterator<Ts...> m_base;
+    const size_t* m_pos = nullptr;
+    mutable const_frame_iterator<Ts...> m_row;
+};
+
+///
+/// A read-only selection of rows from a frame
+///
+/// frame_view is what frame::where() returns: the frame it was made from
+/// plus a selection vector holding the index of each selected row. Nothing
+/// is copied when a view is made; statistics, sorting and groupby work
+/// through the selection, and the rows are only gathered into a new frame
+/// when materialize() is called.
+///
+///     frame<year_month_day, double, bool> f;
+///     ...
+///     auto dry = f.where(_2 == false);
+///     double avg  = dry.mean(_1);
+///     auto bounds = dry.minmax(_1);
+///     auto by_day = dry.groupby(_0).aggregate(agg::mean(_1));
+///     for (auto& row : dry.sorted(_1)) {
+///         ...
+///     }
+///     frame<year_month_day, double, bool> f2 = dry.materialize();
+///
+/// Like a slice(), a view shares the frame's column buffers, so it stays
+/// valid and unchanged if the frame is modified or destroyed later. A view
+/// can't be modified itself; materialize() it first.
+///
+template<typename... Ts>
+class frame_view
+{
+    template<size_t Ind>
+    using column_type = typename detail::pack_element<Ind, Ts...>::type;
+
+public:
+    using const_iterator = frame_view_iterator<Ts...>;
+    using iterator       = const_iterator;
+    using name_array     = std::array<std::string, sizeof...(Ts)>;
+
+    frame_view() = default;
+
+    /// A view of every row of f
+    explicit frame_view(const frame<Ts...>& f)
+        : m_frame(f)
+        , m_rows(f.size())
+    {
+        for (size_t i = 0; i < m_rows.size(); ++i) {
+            m_rows[i] = i;
+        }
+    }
+
+    /// A view of the rows of f at the given indices, in that order. Throws
+    /// std::out_of_range if any of them isn't a row of f.
+    frame_view(const frame<Ts...>& f, std::vector<size_t> rows)
+        : m_frame(f)
+        , m_rows(std::move(rows))
+    {
+        for (size_t r : m_rows) {
+            if (r >= m_frame.size()) {
+                throw std::out_of_range{ "frame size is " + std::to_string(m_frame.size()) +
+                    ", row is " + std::to_string(r) };
+            }
+        }
+    }
+
+    const_iterator
+    begin() const
+    {
+        return cbegin();
+    }
+
+    const_iterator
+    end() const
+    {
+        return cend();
+    }
+
+    const_iterator
+    cbegin() const
+    {
+        return const_iterator{ m_frame.cbegin(), m_rows.data() };
+    }
+
+    const_iterator
+    cend() const
+    {
+        return const_iterator{ m_frame.cbegin(), m_rows.data() + m_rows.size() };
+    }
+
+    /// The selected elements of one column, gathered into a new series
+    template<size_t Ind>
+    series<column_type<Ind>>
+    column(columnindex<Ind> ci) const
+    {
+        const series<column_type<Ind>>& s = m_frame.column(ci);
+        series<column_type<Ind>> out;
+        out.set_name(s.name());
+        detail::gather_rows(s, m_rows, out);
+        return out;
+    }
+
+    template<size_t Ind>
+    std::string
+    column_name() const
+    {
+        return m_frame.template column_name<Ind>();
+    }
+
+    name_array
+    column_names() const
+    {
+        return m_frame.column_names();
+    }
+
+    /// A view of the same rows with only the given columns, in the given
+    /// order
+    template<size_t... Inds>
+    frame_view<column_type<Inds>...>
+    columns(columnindex<Inds>... cols) const
+    {
+        return frame_view<column_type<Inds>...>{ m_frame.columns(cols...), m_rows };
+    }
+
+    template<size_t Ind1, size_t Ind2>
+    double
+    corr(terminal<expr_column<Ind1>> c1, terminal<expr_column<Ind2>> c2) const
+    {
+        using T1 = column_type<Ind1>;
+        using T2 = column_type<Ind2>;
+        if constexpr (std::is_arithmetic<T1>::value && std::is_arithmetic<T2>::value) {
+            const T1* a   = m_frame.column(columnindex<Ind1>{}).data();
+            const T2* b   = m_frame.column(columnindex<Ind2>{}).data();
+            double amean  = mean(columnindex<Ind1>{});
+            double bmean  = mean(columnindex<Ind2>{});
+            double aaccum = 0.0;
+            double baccum = 0.0;
+            double cov    = 0.0;
+            for (size_t r : m_rows) {
+                double adiff = a[r] - amean;
+                double bdiff = b[r] - bmean;
+                aaccum += adiff * adiff;
+                baccum += bdiff * bdiff;
+                cov += adiff * bdiff;
+            }
+            return cov / std::sqrt(aaccum * baccum);
+        }
+        else {
+            return materialize().corr(c1, c2);
+        }
+    }
+
+    bool
+    empty() const
+    {
+        return m_rows.empty();
+    }
+
+    template<size_t... Idx>
+    group<index_defn<Idx...>, Ts...>
+    groupby(columnindex<Idx>...) const
+    {
+        return group<index_defn<Idx...>, Ts...>{ m_frame, m_rows };
+    }
+
+    /// Copy the selected rows into a new frame
+    frame<Ts...>
+    materialize() const
+    {
+        return m_frame.gather(m_rows);
+    }
+
+    /// The mean of the selected elements of a column. Numeric columns are
+    /// read through the selection; any other column is gathered first.
+    template<size_t Ind>
+    double
+    mean(columnindex<Ind> ci) const
+    {
+        using T = column_type<Ind>;
+        if constexpr (std::is_arithmetic<T>::value) {
+            const T* d = m_frame.column(ci).data();
+            double m   = 0.0;
+            for (size_t r : m_rows) {
+                m += d[r];
+            }
+            return m / m_rows.size();
+        }
+        else {
+            return column(ci).mean();
+        }
+    }
+
+    template<size_t Ind>
+    std::pair<column_type<Ind>, column_type<Ind>>
+    minmax(columnindex<Ind> ci) const
+    {
+        using T = column_type<Ind>;
+        if (m_rows.empty()) {
+            return column(ci).minmax();
+        }
+        const series<T>& s = m_frame.column(ci);
+        T minval           = s[m_rows[0]];
+        T maxval           = minval;
+        for (size_t r : m_rows) {
+            minval = std::min(minval, s[r]);
+            maxval = std::max(maxval, s[r]);
+        }
+        return { minval, maxval };
+    }
+
+    size_t
+    num_columns() const
+    {
+        return sizeof...(Ts);
+    }
+
+    _row_proxy<true, Ts...>
+    row(size_t ind) const
+    {
+        return m_frame.row(m_rows.at(ind));
+    }
+
+    /// The index of each selected row in the frame the view was made from
+    const std::vector<size_t>&
+    selection() const
+    {
+        return m_rows;
+    }
+
+    size_t
+    size() const
+    {
+        return m_rows.size();
+    }
+
+    /// Reorder the selection by the given columns, leaving the frame's
+    /// rows where they are. Pass a @ref parallel first to sort on several
+    /// threads.
+    template<size_t... Inds>
+    void
+    sort(columnindex<Inds>... ci)
+    {
+        sort(parallel{ 1 }, ci...);
+    }
+
+    template<size_t... Inds>
+    void
+    sort(parallel p, columnindex<Inds>...)
+    {
+        const frame<Ts...>& f = m_frame;
+        detail::sort_rows<false>(m_rows, p.threads, f.column(columnindex<Inds>{}).data()...);
+    }
+
+    template<size_t... Inds>
+    frame_view<Ts...>
+    sorted(columnindex<Inds>... ci) const
+    {
+        return sorted(parallel{ 1 }, ci...);
+    }
+
+    template<size_t... Inds>
+    frame_view<Ts...>
+    sorted(parallel p, columnindex<Inds>... ci) const
+    {
+        frame_view<Ts...> out{ *this };
+        out.sort(p, ci...);
+        return out;
+    }
+
+    /// The frame the rows are selected from
+    const frame<Ts...>&
+    source() const
+    {
+        return m_frame;
+    }
+
+    template<size_t Ind>
+    double
+    stddev(columnindex<Ind> ci) const
+    {
+        using T = column_type<Ind>;
+        if constexpr (std::is_arithmetic<T>::value) {
+            const T* d    = m_frame.column(ci).data();
+            double m      = mean(ci);
+            double sqdist = 0.0;
+            for (size_t r : m_rows) {
+                double dist = d[r] - m;
+                sqdist += dist * dist;
+            }
+            return std::sqrt(sqdist / m_rows.size());
+        }
+        else {
+            return column(ci).stddev();
+        }
+    }
+
+    /// Narrow the selection to the rows for which ex is also true. ex is
+    /// evaluated over the source frame, so offsets like _1[-1] refer to
+    /// the neighbouring rows of the frame rather than of the view.
+    template<typename Ex>
+    std::enable_if_t<is_expression<Ex>::value, frame_view<Ts...>>
+    where(Ex ex) const
+    {
+        frame_view<Ts...> out;
+        out.m_frame = m_frame;
+        auto b      = m_frame.cbegin();
+        auto e      = m_frame.cend();
+        for (size_t r : m_rows) {
+            if (ex(b, b + static_cast<ptrdiff_t>(r), e)) {
+                out.m_rows.push_back(r);
+            }
+        }
+        return out;
+    }
+
+private:
+    frame<Ts...> m_frame;
+    std::vector<size_t> m_rows;
+};
+
+} // namespace mf
+
+
+#endif // INCLUDED_mainframe_frame_view_h
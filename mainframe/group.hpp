@@ -95,6 +95,11 @@ public:
         : frame_indexer<index_defn<GroupInds...>, Ts...>(f)
     {}
 
+    /// Group only the given rows of f, as frame_view::groupby() does
+    group(frame<Ts...> f, std::vector<size_t> rows)
+        : frame_indexer<index_defn<GroupInds...>, Ts...>(f, std::move(rows))
+    {}
+
     template<typename... Ops>
     typename get_aggregate_frame<Ops...>::type
     aggregate(Ops...) const
@@ -9,8 +9,10 @@
 #include <array>
 #include <cmath>
 #include <iomanip>
+#include <iterator>
 #include <list>
 #include <memory>
+#include <numeric>
 #include <ostream>
 #include <sstream>
 #include <stdexcept>
@@ -39,6 +41,19 @@ frame<Ts...>::frame(const series<typename detail::pack_element<0, Ts...>::type>&
     std::get<0>(m_columns) = s;
 }
 
+template<typename... Ts>
+frame<Ts...>::frame(memory_resource* resource)
+    : m_columns(series<Ts>(resource)...)
+{}
+
+template<typename... Ts>
+template<size_t N, std::enable_if_t<(N > 1), bool>>
+frame<Ts...>::frame(const series<Ts>&... columns)
+    : m_columns(columns...)
+{
+    size_impl_with_check<0, Ts...>();
+}
+
 template<typename... Ts>
 typename frame<Ts...>::iterator
 frame<Ts...>::begin()
@@ -222,6 +237,41 @@ frame<Ts...>::append_series(const series<T>& s) const
     return plust;
 }
 
+template<typename... Ts>
+template<typename... Cs>
+void
+frame<Ts...>::append_columns(const Cs&... cols)
+{
+    static_assert(sizeof...(Cs) == sizeof...(Ts), "append_columns() needs one range per column");
+    const size_t lengths[] = { static_cast<size_t>(
+        std::distance(std::begin(cols), std::end(cols)))... };
+    for (size_t len : lengths) {
+        if (len != lengths[0]) {
+            throw std::invalid_argument{ "append_columns() columns have different lengths" };
+        }
+    }
+    if (lengths[0] == 0) {
+        return;
+    }
+    append_columns_impl<0>(cols...);
+}
+
+template<typename... Ts>
+template<size_t... Inds>
+std::vector<size_t>
+frame<Ts...>::argsort(columnindex<Inds>... ci) const
+{
+    return argsort(parallel{ 1 }, ci...);
+}
+
+template<typename... Ts>
+template<size_t... Inds>
+std::vector<size_t>
+frame<Ts...>::argsort(parallel p, columnindex<Inds>...) const
+{
+    return argsort_impl<false, Inds...>(p.threads);
+}
+
 template<typename... Ts>
 void
 frame<Ts...>::clear()
@@ -423,6 +473,37 @@ frame<Ts...>::fill_backward() const
     return out.reversed();
 }
 
+template<typename... Ts>
+frame<Ts...>
+frame<Ts...>::filter(const mask& m) const
+{
+    if (m.size() != size()) {
+        throw std::invalid_argument{ "filter() mask size is " + std::to_string(m.size()) +
+            ", frame size is " + std::to_string(size()) };
+    }
+    frame<Ts...> out;
+    out.set_column_names(column_names());
+    filter_impl<0>(out, m, m.count());
+    return out;
+}
+
+template<typename... Ts>
+frame<Ts...>
+frame<Ts...>::gather(const std::vector<size_t>& rows) const
+{
+    size_t num_rows = size();
+    for (size_t r : rows) {
+        if (r >= num_rows) {
+            throw std::out_of_range{ "gather() row is " + std::to_string(r) +
+                ", frame size is " + std::to_string(num_rows) };
+        }
+    }
+    frame<Ts...> out;
+    out.set_column_names(column_names());
+    gather_impl<0>(out, rows, 1);
+    return out;
+}
+
 template<typename... Ts>
 template<size_t... Idx>
 group<index_defn<Idx...>, Ts...>
@@ -480,6 +561,21 @@ frame<Ts...>::insert(typename frame<Ts...>::iterator pos, size_t count, const Ts
     return typename frame<Ts...>::iterator{ ptrs };
 }
 
+template<typename... Ts>
+template<typename Ex>
+std::enable_if_t<is_expression<Ex>::value, mask>
+frame<Ts...>::make_mask(Ex ex) const
+{
+    size_t num_rows = size();
+    mask out(num_rows);
+    uint64_t* words = out.data();
+    for (size_t first = 0; first < num_rows; first += detail::mask_block_rows) {
+        size_t num = std::min(detail::mask_block_rows, num_rows - first);
+        mask_words_impl(ex, first, num, words + first / 64);
+    }
+    return out;
+}
+
 template<typename... Ts>
 template<typename T, typename Ex>
 series<T>
@@ -490,6 +586,15 @@ frame<Ts...>::make_series(const std::string& series_name, Ex expr) const
     return plust.column(ci);
 }
 
+template<typename... Ts>
+template<size_t... Inds>
+sort_keys<typename detail::pack_element<Inds, Ts...>::type...>
+frame<Ts...>::make_sort_keys(columnindex<Inds>...) const
+{
+    return sort_keys<typename detail::pack_element<Inds, Ts...>::type...>{ std::get<Inds>(
+        m_columns)... };
+}
+
 template<typename... Ts>
 template<size_t Ind>
 double
@@ -499,6 +604,15 @@ frame<Ts...>::mean(columnindex<Ind>) const
     return s.mean();
 }
 
+template<typename... Ts>
+memory_stats
+frame<Ts...>::memory_usage() const
+{
+    memory_stats out;
+    memory_usage_impl<0>(out);
+    return out;
+}
+
 template<typename... Ts>
 template<size_t Ind>
 typename frame<Ts...>::template pack_elem_pair<Ind>
@@ -519,7 +633,10 @@ template<typename... Ts>
 frame<Ts...>
 frame<Ts...>::operator+(const frame<Ts...>& other) const
 {
-    frame<Ts...> out{ *this };
+    frame<Ts...> out;
+    out.set_column_names(column_names());
+    out.reserve(size() + other.size());
+    out.insert(out.end(), cbegin(), cend());
     out.insert(out.end(), other.cbegin(), other.cend());
     return out;
 }
@@ -746,10 +863,17 @@ frame<Ts...>::reversed() const
 template<typename... Ts>
 template<size_t... Inds>
 void
-frame<Ts...>::reverse_sort(columnindex<Inds>...)
+frame<Ts...>::reverse_sort(columnindex<Inds>... ci)
+{
+    reverse_sort(parallel{ 1 }, ci...);
+}
+
+template<typename... Ts>
+template<size_t... Inds>
+void
+frame<Ts...>::reverse_sort(parallel p, columnindex<Inds>...)
 {
-    detail::build_gt<row_type, Inds...> op;
-    std::sort(this->begin(), this->end(), op);
+    apply_order_impl<0>(argsort_impl<true, Inds...>(p.threads), p.threads);
 }
 
 template<typename... Ts>
@@ -757,9 +881,17 @@ template<size_t... Inds>
 frame<Ts...>
 frame<Ts...>::reverse_sorted(columnindex<Inds>... ci) const
 {
-    frame<Ts...> out(*this);
+    return reverse_sorted(parallel{ 1 }, ci...);
+}
+
+template<typename... Ts>
+template<size_t... Inds>
+frame<Ts...>
+frame<Ts...>::reverse_sorted(parallel p, columnindex<Inds>...) const
+{
+    frame<Ts...> out;
     out.set_column_names(column_names());
-    out.reverse_sort(ci...);
+    gather_impl<0>(out, argsort_impl<true, Inds...>(p.threads), p.threads);
     return out;
 }
 
@@ -784,20 +916,7 @@ template<typename Ex>
 std::enable_if_t<is_expression<Ex>::value, frame<Ts...>>
 frame<Ts...>::rows(Ex ex) const
 {
-    frame<Ts...> out;
-    out.set_column_names(column_names());
-
-    auto b    = cbegin();
-    auto curr = b;
-    auto e    = cend();
-    for (; curr != e; ++curr) {
-        auto exprval = ex(b, curr, e);
-        if (exprval) {
-            out.push_back(*curr);
-        }
-    }
-
-    return out;
+    return filter(make_mask(ex));
 }
 
 template<typename... Ts>
@@ -822,6 +941,13 @@ frame<Ts...>::set_column_names(const Us&... colnames)
     set_column_names_impl<0, Us...>(colnames...);
 }
 
+template<typename... Ts>
+void
+frame<Ts...>::shrink_to_fit()
+{
+    shrink_to_fit_impl<0>();
+}
+
 template<typename... Ts>
 size_t
 frame<Ts...>::size() const
@@ -829,13 +955,29 @@ frame<Ts...>::size() const
     return size_impl_with_check<0, Ts...>();
 }
 
+template<typename... Ts>
+frame<Ts...>
+frame<Ts...>::slice(size_t begin, size_t end) const
+{
+    frame<Ts...> out;
+    slice_impl<0>(out, begin, end);
+    return out;
+}
+
 template<typename... Ts>
 template<size_t... Inds>
 void
-frame<Ts...>::sort(columnindex<Inds>...)
+frame<Ts...>::sort(columnindex<Inds>... ci)
 {
-    detail::build_lt<row_type, Inds...> op;
-    std::sort(this->begin(), this->end(), op);
+    sort(parallel{ 1 }, ci...);
+}
+
+template<typename... Ts>
+template<size_t... Inds>
+void
+frame<Ts...>::sort(parallel p, columnindex<Inds>...)
+{
+    apply_order_impl<0>(argsort_impl<false, Inds...>(p.threads), p.threads);
 }
 
 template<typename... Ts>
@@ -843,9 +985,17 @@ template<size_t... Inds>
 frame<Ts...>
 frame<Ts...>::sorted(columnindex<Inds>... ci) const
 {
-    frame<Ts...> out(*this);
+    return sorted(parallel{ 1 }, ci...);
+}
+
+template<typename... Ts>
+template<size_t... Inds>
+frame<Ts...>
+frame<Ts...>::sorted(parallel p, columnindex<Inds>...) const
+{
+    frame<Ts...> out;
     out.set_column_names(column_names());
-    out.sort(ci...);
+    gather_impl<0>(out, argsort_impl<false, Inds...>(p.threads), p.threads);
     return out;
 }
 
@@ -867,6 +1017,18 @@ frame<Ts...>::to_string() const
     return out;
 }
 
+template<typename... Ts>
+template<typename Ex>
+std::enable_if_t<is_expression<Ex>::value, frame_view<Ts...>>
+frame<Ts...>::where(Ex ex) const
+{
+    mask m = make_mask(ex);
+    std::vector<size_t> rows;
+    rows.reserve(m.count());
+    m.for_each_set([&](size_t n) { rows.push_back(n); });
+    return frame_view<Ts...>{ *this, std::move(rows) };
+}
+
 // ================ private =================
 
 template<typename... Ts>
@@ -898,6 +1060,45 @@ frame<Ts...>::allow_missing_impl(uframe& uf) const
     }
 }
 
+template<typename... Ts>
+template<size_t Ind, typename C, typename... Cs>
+void
+frame<Ts...>::append_columns_impl(const C& col, const Cs&... cols)
+{
+    auto& s = std::get<Ind>(m_columns);
+    s.insert(s.cend(), std::begin(col), std::end(col));
+    if constexpr (Ind + 1 < sizeof...(Ts)) {
+        append_columns_impl<Ind + 1>(cols...);
+    }
+}
+
+template<typename... Ts>
+template<size_t Ind>
+void
+frame<Ts...>::apply_order_impl(const std::vector<size_t>& order, unsigned threads)
+{
+    using T = typename detail::pack_element<Ind, Ts...>::type;
+    auto& s = std::get<Ind>(m_columns);
+    series<T> out(s.get_memory_resource());
+    detail::gather_rows(s, order, out, threads);
+    out.set_name(s.name());
+    s = std::move(out);
+    if constexpr (Ind + 1 < sizeof...(Ts)) {
+        apply_order_impl<Ind + 1>(order, threads);
+    }
+}
+
+template<typename... Ts>
+template<bool Reverse, size_t... Inds>
+std::vector<size_t>
+frame<Ts...>::argsort_impl(unsigned threads) const
+{
+    std::vector<size_t> order(size());
+    std::iota(order.begin(), order.end(), size_t{ 0 });
+    detail::sort_rows<Reverse>(order, threads, std::get<Inds>(m_columns).data()...);
+    return order;
+}
+
 template<typename... Ts>
 template<size_t Ind>
 void
@@ -1040,6 +1241,41 @@ frame<Ts...>::eq_impl(const frame<Ts...>& other) const
     return true;
 }
 
+template<typename... Ts>
+template<size_t Ind>
+void
+frame<Ts...>::filter_impl(frame<Ts...>& out, const mask& m, size_t count) const
+{
+    using T       = typename detail::pack_element<Ind, Ts...>::type;
+    const auto& s = std::get<Ind>(m_columns);
+    auto& os      = std::get<Ind>(out.m_columns);
+    if constexpr (std::is_trivially_copyable<T>::value) {
+        if (count > 0) {
+            os.resize(count);
+            detail::compress(s.data(), m.data(), m.size(), os.data());
+        }
+    }
+    else {
+        os.reserve(count);
+        m.for_each_set([&](size_t n) { os.push_back(s[n]); });
+    }
+    if constexpr (Ind + 1 < sizeof...(Ts)) {
+        filter_impl<Ind + 1>(out, m, count);
+    }
+}
+
+template<typename... Ts>
+template<size_t Ind>
+void
+frame<Ts...>::gather_impl(
+    frame<Ts...>& out, const std::vector<size_t>& rows, unsigned threads) const
+{
+    detail::gather_rows(std::get<Ind>(m_columns), rows, std::get<Ind>(out.m_columns), threads);
+    if constexpr (Ind + 1 < sizeof...(Ts)) {
+        gather_impl<Ind + 1>(out, rows, threads);
+    }
+}
+
 template<typename... Ts>
 template<size_t Ind, typename U, typename... Us>
 void
@@ -1074,6 +1310,111 @@ frame<Ts...>::insert_impl(
     }
 }
 
+template<typename... Ts>
+template<typename Ex>
+void
+frame<Ts...>::mask_words_impl(const Ex& ex, size_t first, size_t num, uint64_t* words) const
+{
+    mask_words_rows(ex, first, num, words);
+}
+
+template<typename... Ts>
+template<typename Op, typename L, typename R>
+void
+frame<Ts...>::mask_words_impl(
+    const binary_expr<Op, L, R>& ex, size_t first, size_t num, uint64_t* words) const
+{
+    using detail::expr_result_t;
+    using bool_result = std::is_same<expr_result_t<binary_expr<Op, L, R>, const_iterator>, bool>;
+    if constexpr (bool_result::value && std::is_same<Op, expr_op::AND>::value &&
+        std::is_same<expr_result_t<L, const_iterator>, bool>::value &&
+        std::is_same<expr_result_t<R, const_iterator>, bool>::value) {
+        uint64_t rwords[detail::mask_block_words];
+        mask_words_impl(ex.l, first, num, words);
+        mask_words_impl(ex.r, first, num, rwords);
+        for (size_t w = 0; w * 64 < num; ++w) {
+            words[w] &= rwords[w];
+        }
+    }
+    else if constexpr (bool_result::value && std::is_same<Op, expr_op::OR>::value &&
+        std::is_same<expr_result_t<L, const_iterator>, bool>::value &&
+        std::is_same<expr_result_t<R, const_iterator>, bool>::value) {
+        uint64_t rwords[detail::mask_block_words];
+        mask_words_impl(ex.l, first, num, words);
+        mask_words_impl(ex.r, first, num, rwords);
+        for (size_t w = 0; w * 64 < num; ++w) {
+            words[w] |= rwords[w];
+        }
+    }
+    else if constexpr (bool_result::value && detail::is_comparison_op<Op>::value &&
+        detail::is_column_terminal<L>::value && detail::is_value_terminal<R>::value) {
+        const auto* d = std::get<L::index>(m_columns).data() + first;
+        detail::fill_mask_words(words, num, [&](size_t j) { return Op::exec(d[j], ex.r.t); });
+    }
+    else if constexpr (bool_result::value && detail::is_comparison_op<Op>::value &&
+        detail::is_value_terminal<L>::value && detail::is_column_terminal<R>::value) {
+        const auto* d = std::get<R::index>(m_columns).data() + first;
+        detail::fill_mask_words(words, num, [&](size_t j) { return Op::exec(ex.l.t, d[j]); });
+    }
+    else if constexpr (bool_result::value && detail::is_comparison_op<Op>::value &&
+        detail::is_column_terminal<L>::value && detail::is_column_terminal<R>::value) {
+        const auto* dl = std::get<L::index>(m_columns).data() + first;
+        const auto* dr = std::get<R::index>(m_columns).data() + first;
+        detail::fill_mask_words(words, num, [&](size_t j) { return Op::exec(dl[j], dr[j]); });
+    }
+    else {
+        mask_words_rows(ex, first, num, words);
+    }
+}
+
+template<typename... Ts>
+template<typename T>
+void
+frame<Ts...>::mask_words_impl(
+    const unary_expr<expr_op::NOT, T>& ex, size_t first, size_t num, uint64_t* words) const
+{
+    if constexpr (std::is_same<detail::expr_result_t<T, const_iterator>, bool>::value) {
+        mask_words_impl(ex.t, first, num, words);
+        size_t num_words = (num + 63) / 64;
+        for (size_t w = 0; w < num_words; ++w) {
+            words[w] = ~words[w];
+        }
+        if (num % 64 != 0) {
+            words[num_words - 1] &= (uint64_t{ 1 } << (num % 64)) - 1;
+        }
+    }
+    else {
+        mask_words_rows(ex, first, num, words);
+    }
+}
+
+template<typename... Ts>
+template<typename Ex>
+void
+frame<Ts...>::mask_words_rows(const Ex& ex, size_t first, size_t num, uint64_t* words) const
+{
+    auto b    = cbegin();
+    auto e    = cend();
+    auto curr = b + first;
+    detail::fill_mask_words(words, num, [&](size_t) {
+        auto exprval = ex(b, curr, e);
+        ++curr;
+        return static_cast<bool>(exprval);
+    });
+}
+
+template<typename... Ts>
+template<size_t Ind>
+void
+frame<Ts...>::memory_usage_impl(memory_stats& out) const
+{
+    const auto& s = std::get<Ind>(m_columns);
+    out += s.memory_usage();
+    if constexpr (Ind + 1 < sizeof...(Ts)) {
+        memory_usage_impl<Ind + 1>(out);
+    }
+}
+
 template<typename... Ts>
 template<size_t Ind>
 void
@@ -1232,6 +1573,18 @@ frame<Ts...>::set_column_names_impl(const U& colname, const Us&... colnames)
     }
 }
 
+template<typename... Ts>
+template<size_t Ind>
+void
+frame<Ts...>::shrink_to_fit_impl()
+{
+    auto& s = std::get<Ind>(m_columns);
+    s.shrink_to_fit();
+    if constexpr (Ind + 1 < sizeof...(Ts)) {
+        shrink_to_fit_impl<Ind + 1>();
+    }
+}
+
 template<typename... Ts>
 template<size_t Ind, typename U, typename... Us>
 size_t
@@ -1248,6 +1601,17 @@ frame<Ts...>::size_impl_with_check() const
     return s;
 }
 
+template<typename... Ts>
+template<size_t Ind>
+void
+frame<Ts...>::slice_impl(frame<Ts...>& out, size_t begin, size_t end) const
+{
+    std::get<Ind>(out.m_columns) = std::get<Ind>(m_columns).slice(begin, end);
+    if constexpr (Ind + 1 < sizeof...(Ts)) {
+        slice_impl<Ind + 1>(out, begin, end);
+    }
+}
+
 template<typename... Ts>
 template<size_t Ind, typename U, typename... Us>
 void
@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "mainframe/detail/base.hpp"
+#include "mainframe/detail/radix_sort.hpp"
 #include "mainframe/detail/series_vector.hpp"
 #include "mainframe/detail/useries.hpp"
 #include "mainframe/missing.hpp"
@@ -31,8 +32,11 @@ namespace mf
 {
 
 template<typename T>
-series<T>::series()
-    : m_sharedvec(std::make_shared<series_vector<T>>())
+series<T>::series() = default;
+
+template<typename T>
+series<T>::series(memory_resource* resource)
+    : m_resource(resource)
 {}
 
 template<typename T>
@@ -52,19 +56,28 @@ series<T>::series(InputIt f, InputIt l)
 {}
 
 template<typename T>
-series<T>::series(series&& other)
+series<T>::series(series&& other) noexcept
     : m_name(std::move(other.m_name))
     , m_sharedvec(std::move(other.m_sharedvec))
-{
-    // Don't leave other with nullptr
-    other.m_sharedvec = std::make_shared<series_vector<T>>();
-}
+    , m_resource(other.m_resource)
+{}
 
 template<typename T>
 series<T>::series(std::initializer_list<T> init)
     : m_sharedvec(std::make_shared<series_vector<T>>(init))
 {}
 
+template<typename T>
+series<T>::series(std::shared_ptr<const void> owner, const T* first, const T* last)
+    : m_sharedvec(std::make_shared<series_vector<T>>(std::move(owner), first, last))
+{}
+
+template<typename T>
+template<typename Deleter>
+series<T>::series(T* first, size_t count, Deleter deleter)
+    : series(std::shared_ptr<const void>(first, std::move(deleter)), first, first + count)
+{}
+
 template<typename T>
 typename series<T>::iterator
 series<T>::begin()
@@ -77,14 +90,14 @@ template<typename T>
 typename series<T>::const_iterator
 series<T>::begin() const
 {
-    return m_sharedvec->begin();
+    return cvec().begin();
 }
 
 template<typename T>
 typename series<T>::const_iterator
 series<T>::cbegin() const
 {
-    return m_sharedvec->cbegin();
+    return cvec().cbegin();
 }
 
 template<typename T>
@@ -99,14 +112,14 @@ template<typename T>
 typename series<T>::const_iterator
 series<T>::end() const
 {
-    return m_sharedvec->end();
+    return cvec().end();
 }
 
 template<typename T>
 typename series<T>::const_iterator
 series<T>::cend() const
 {
-    return m_sharedvec->cend();
+    return cvec().cend();
 }
 
 template<typename T>
@@ -121,14 +134,14 @@ template<typename T>
 typename series<T>::const_reverse_iterator
 series<T>::rbegin() const
 {
-    return m_sharedvec->rbegin();
+    return cvec().rbegin();
 }
 
 template<typename T>
 typename series<T>::const_reverse_iterator
 series<T>::crbegin() const
 {
-    return m_sharedvec->crbegin();
+    return cvec().crbegin();
 }
 
 template<typename T>
@@ -143,14 +156,14 @@ template<typename T>
 typename series<T>::const_reverse_iterator
 series<T>::rend() const
 {
-    return m_sharedvec->rend();
+    return cvec().rend();
 }
 
 template<typename T>
 typename series<T>::const_reverse_iterator
 series<T>::crend() const
 {
-    return m_sharedvec->crend();
+    return cvec().crend();
 }
 
 template<typename T>
@@ -167,7 +180,7 @@ series<mi<T>>
 series<T>::allow_missing() const
 {
     series<mi<T>> os;
-    for (auto& e : *m_sharedvec) {
+    for (auto& e : cvec()) {
         os.push_back(e);
     }
     os.set_name(name());
@@ -208,7 +221,7 @@ template<typename T>
 typename series<T>::const_reference
 series<T>::at(size_t n) const
 {
-    return m_sharedvec->at(n);
+    return cvec().at(n);
 }
 
 template<typename T>
@@ -223,21 +236,22 @@ template<typename T>
 typename series<T>::const_reference
 series<T>::back() const
 {
-    return m_sharedvec->back();
+    return cvec().back();
 }
 
 template<typename T>
 size_t
 series<T>::capacity() const
 {
-    return m_sharedvec->capacity();
+    return cvec().capacity();
 }
 
 template<typename T>
 void
 series<T>::clear()
 {
-    m_sharedvec = std::make_shared<series_vector<T>>();
+    m_resource = get_memory_resource();
+    m_sharedvec.reset();
 }
 
 template<typename T>
@@ -252,7 +266,7 @@ template<typename T>
 const T*
 series<T>::data() const
 {
-    return m_sharedvec->data();
+    return cvec().data();
 }
 
 template<typename T>
@@ -265,7 +279,7 @@ series<T>::disallow_missing() const
 {
     using V = typename T::value_type;
     series<V> s;
-    for (auto& e : *m_sharedvec) {
+    for (auto& e : cvec()) {
         if (e.has_value()) {
             s.push_back(*e);
         }
@@ -290,7 +304,7 @@ template<class... Args>
 typename series<T>::iterator
 series<T>::emplace(typename series<T>::const_iterator pos, Args&&... args)
 {
-    if (m_sharedvec->cbegin() <= pos && pos <= m_sharedvec->cend()) {
+    if (!m_sharedvec || (cvec().cbegin() <= pos && pos <= cvec().cend())) {
         pos = unref(pos);
     }
     return m_sharedvec->emplace(pos, std::forward<T>(args...));
@@ -309,14 +323,14 @@ template<typename T>
 bool
 series<T>::empty() const
 {
-    return m_sharedvec->empty();
+    return cvec().empty();
 }
 
 template<typename T>
 typename series<T>::iterator
 series<T>::erase(typename series<T>::const_iterator pos)
 {
-    if (m_sharedvec->cbegin() <= pos && pos <= m_sharedvec->cend()) {
+    if (!m_sharedvec || (cvec().cbegin() <= pos && pos <= cvec().cend())) {
         pos = unref(pos);
     }
     return m_sharedvec->erase(pos);
@@ -326,7 +340,7 @@ template<typename T>
 typename series<T>::iterator
 series<T>::erase(typename series<T>::const_iterator first, typename series<T>::const_iterator last)
 {
-    if (m_sharedvec->cbegin() <= first && first < last && last <= m_sharedvec->cend()) {
+    if (!m_sharedvec || (cvec().cbegin() <= first && first < last && last <= cvec().cend())) {
         auto diff = last - first;
         first     = unref(first);
         last      = first + diff;
@@ -346,14 +360,21 @@ template<typename T>
 typename series<T>::const_reference
 series<T>::front() const
 {
-    return m_sharedvec->front();
+    return cvec().front();
+}
+
+template<typename T>
+memory_resource*
+series<T>::get_memory_resource() const
+{
+    return m_sharedvec ? m_sharedvec->get_memory_resource() : m_resource;
 }
 
 template<typename T>
 typename series<T>::iterator
 series<T>::insert(typename series<T>::const_iterator pos, const T& value)
 {
-    if (m_sharedvec->cbegin() <= pos && pos <= m_sharedvec->cend()) {
+    if (!m_sharedvec || (cvec().cbegin() <= pos && pos <= cvec().cend())) {
         pos = unref(pos);
     }
     return m_sharedvec->insert(pos, value);
@@ -363,7 +384,7 @@ template<typename T>
 typename series<T>::iterator
 series<T>::insert(typename series<T>::const_iterator pos, T&& value)
 {
-    if (m_sharedvec->cbegin() <= pos && pos <= m_sharedvec->cend()) {
+    if (!m_sharedvec || (cvec().cbegin() <= pos && pos <= cvec().cend())) {
         pos = unref(pos);
     }
     return m_sharedvec->insert(pos, std::move(value));
@@ -373,7 +394,7 @@ template<typename T>
 typename series<T>::iterator
 series<T>::insert(typename series<T>::const_iterator pos, size_t count, const T& value)
 {
-    if (m_sharedvec->cbegin() <= pos && pos <= m_sharedvec->cend() && count > 0) {
+    if (!m_sharedvec || (cvec().cbegin() <= pos && pos <= cvec().cend() && count > 0)) {
         pos = unref(pos);
     }
     return m_sharedvec->insert(pos, count, value);
@@ -384,7 +405,7 @@ template<typename InputIt>
 typename series<T>::iterator
 series<T>::insert(typename series<T>::const_iterator pos, InputIt first, InputIt last)
 {
-    if (m_sharedvec->cbegin() <= pos && pos <= m_sharedvec->cend() && last > first) {
+    if (!m_sharedvec || (cvec().cbegin() <= pos && pos <= cvec().cend() && last > first)) {
         pos = unref(pos);
     }
     return m_sharedvec->insert(pos, first, last);
@@ -394,7 +415,7 @@ template<typename T>
 typename series<T>::iterator
 series<T>::insert(typename series<T>::const_iterator pos, std::initializer_list<T> init)
 {
-    if (m_sharedvec->cbegin() <= pos && pos <= m_sharedvec->cend() && !init.empty()) {
+    if (!m_sharedvec || (cvec().cbegin() <= pos && pos <= cvec().cend() && !init.empty())) {
         pos = unref(pos);
     }
     return m_sharedvec->insert(pos, init);
@@ -404,7 +425,7 @@ template<typename T>
 size_t
 series<T>::max_size() const
 {
-    return m_sharedvec->max_size();
+    return cvec().max_size();
 }
 
 template<typename T>
@@ -415,6 +436,27 @@ series<T>::mean() const
     return m;
 }
 
+template<typename T>
+memory_stats
+series<T>::memory_usage() const
+{
+    memory_stats out;
+    if (!m_sharedvec) {
+        return out;
+    }
+    out.logical_bytes  = size() * sizeof(T);
+    out.capacity_bytes = capacity() * sizeof(T);
+    if (m_sharedvec.use_count() > 1 || m_sharedvec->borrowed()) {
+        out.shared_bytes = out.capacity_bytes;
+    }
+    if constexpr (!std::is_trivially_copyable<T>::value) {
+        for (const T& t : cvec()) {
+            out.out_of_line_bytes += detail::heap_bytes(t);
+        }
+    }
+    return out;
+}
+
 template<typename T>
 std::pair<T, T>
 series<T>::minmax() const
@@ -427,9 +469,9 @@ series<T>::minmax() const
             return { T(), T() };
         }
     }
-    T minval = m_sharedvec->at(0);
+    T minval = cvec().at(0);
     T maxval = minval;
-    for (const T& t : *m_sharedvec) {
+    for (const T& t : cvec()) {
         minval = std::min(minval, t);
         maxval = std::max(maxval, t);
     }
@@ -445,11 +487,11 @@ series<T>::name() const
 
 template<typename T>
 series<T>&
-series<T>::operator=(series&& other)
+series<T>::operator=(series&& other) noexcept
 {
-    m_name            = other.m_name;
-    m_sharedvec       = std::move(other.m_sharedvec);
-    other.m_sharedvec = std::make_shared<series_vector<T>>();
+    m_name      = std::move(other.m_name);
+    m_sharedvec = std::move(other.m_sharedvec);
+    m_resource  = other.m_resource;
     return *this;
 }
 
@@ -473,21 +515,21 @@ template<typename T>
 typename series<T>::const_reference
 series<T>::operator[](size_t n) const
 {
-    return (*m_sharedvec)[n];
+    return cvec()[n];
 }
 
 template<typename T>
 bool
 series<T>::operator==(const series<T>& other) const
 {
-    return m_name == other.m_name && *m_sharedvec == *(other.m_sharedvec);
+    return m_name == other.m_name && cvec() == other.cvec();
 }
 
 template<typename T>
 bool
 series<T>::operator!=(const series<T>& other) const
 {
-    return m_name != other.m_name || *m_sharedvec != *(other.m_sharedvec);
+    return m_name != other.m_name || cvec() != other.cvec();
 }
 
 template<typename T>
@@ -552,8 +594,8 @@ series<T>::operator+=(const series<U>& other)
 {
     unref();
     auto it1 = m_sharedvec->begin();
-    auto it2 = other.m_sharedvec->begin();
-    while (it1 != m_sharedvec->end() && it2 != other.m_sharedvec->end()) {
+    auto it2 = other.cvec().begin();
+    while (it1 != m_sharedvec->end() && it2 != other.cvec().end()) {
         *it1 += *it2;
         ++it1;
         ++it2;
@@ -567,8 +609,8 @@ series<T>::operator-=(const series<U>& other)
 {
     unref();
     auto it1 = m_sharedvec->begin();
-    auto it2 = other.m_sharedvec->begin();
-    while (it1 != m_sharedvec->end() && it2 != other.m_sharedvec->end()) {
+    auto it2 = other.cvec().begin();
+    while (it1 != m_sharedvec->end() && it2 != other.cvec().end()) {
         *it1 -= *it2;
         ++it1;
         ++it2;
@@ -582,8 +624,8 @@ series<T>::operator*=(const series<U>& other)
 {
     unref();
     auto it1 = m_sharedvec->begin();
-    auto it2 = other.m_sharedvec->begin();
-    while (it1 != m_sharedvec->end() && it2 != other.m_sharedvec->end()) {
+    auto it2 = other.cvec().begin();
+    while (it1 != m_sharedvec->end() && it2 != other.cvec().end()) {
         *it1 *= *it2;
         ++it1;
         ++it2;
@@ -597,8 +639,8 @@ series<T>::operator/=(const series<U>& other)
 {
     unref();
     auto it1 = m_sharedvec->begin();
-    auto it2 = other.m_sharedvec->begin();
-    while (it1 != m_sharedvec->end() && it2 != other.m_sharedvec->end()) {
+    auto it2 = other.cvec().begin();
+    while (it1 != m_sharedvec->end() && it2 != other.cvec().end()) {
         *it1 /= *it2;
         ++it1;
         ++it2;
@@ -612,8 +654,8 @@ series<T>::operator%=(const series<U>& other)
 {
     unref();
     auto it1 = m_sharedvec->begin();
-    auto it2 = other.m_sharedvec->begin();
-    while (it1 != m_sharedvec->end() && it2 != other.m_sharedvec->end()) {
+    auto it2 = other.cvec().begin();
+    while (it1 != m_sharedvec->end() && it2 != other.cvec().end()) {
         *it1 %= *it2;
         ++it1;
         ++it2;
@@ -627,8 +669,8 @@ series<T>::operator+(const U& value) const
 {
     using V = decltype(std::declval<T>() + std::declval<U>());
     series<V> result;
-    for (const T& t : *m_sharedvec) {
-        result.m_sharedvec->push_back(t + value);
+    for (const T& t : cvec()) {
+        result.push_back(t + value);
     }
     return result;
 }
@@ -640,8 +682,8 @@ series<T>::operator-(const U& value) const
 {
     using V = decltype(std::declval<T>() - std::declval<U>());
     series<V> result;
-    for (const T& t : *m_sharedvec) {
-        result.m_sharedvec->push_back(t - value);
+    for (const T& t : cvec()) {
+        result.push_back(t - value);
     }
     return result;
 }
@@ -653,8 +695,8 @@ series<T>::operator*(const U& value) const
 {
     using V = decltype(std::declval<T>() * std::declval<U>());
     series<V> result;
-    for (const T& t : *m_sharedvec) {
-        result.m_sharedvec->push_back(t * value);
+    for (const T& t : cvec()) {
+        result.push_back(t * value);
     }
     return result;
 }
@@ -666,8 +708,8 @@ series<T>::operator/(const U& value) const
 {
     using V = decltype(std::declval<T>() / std::declval<U>());
     series<V> result;
-    for (const T& t : *m_sharedvec) {
-        result.m_sharedvec->push_back(t / value);
+    for (const T& t : cvec()) {
+        result.push_back(t / value);
     }
     return result;
 }
@@ -679,8 +721,8 @@ series<T>::operator%(const U& value) const
 {
     using V = decltype(std::declval<T>() % std::declval<U>());
     series<V> result;
-    for (const T& t : *m_sharedvec) {
-        result.m_sharedvec->push_back(t % value);
+    for (const T& t : cvec()) {
+        result.push_back(t % value);
     }
     return result;
 }
@@ -692,10 +734,10 @@ series<T>::operator+(const series<U>& other) const
 {
     using V = decltype(std::declval<T>() + std::declval<U>());
     series<V> result;
-    auto it1 = m_sharedvec->begin();
-    auto it2 = other.m_sharedvec->begin();
-    while (it1 != m_sharedvec->end() && it2 != other.m_sharedvec->end()) {
-        result.m_sharedvec->push_back(*it1 + *it2);
+    auto it1 = cvec().begin();
+    auto it2 = other.cvec().begin();
+    while (it1 != cvec().end() && it2 != other.cvec().end()) {
+        result.push_back(*it1 + *it2);
         ++it1;
         ++it2;
     }
@@ -709,10 +751,10 @@ series<T>::operator-(const series<U>& other) const
 {
     using V = decltype(std::declval<T>() - std::declval<U>());
     series<V> result;
-    auto it1 = m_sharedvec->begin();
-    auto it2 = other.m_sharedvec->begin();
-    while (it1 != m_sharedvec->end() && it2 != other.m_sharedvec->end()) {
-        result.m_sharedvec->push_back(*it1 - *it2);
+    auto it1 = cvec().begin();
+    auto it2 = other.cvec().begin();
+    while (it1 != cvec().end() && it2 != other.cvec().end()) {
+        result.push_back(*it1 - *it2);
         ++it1;
         ++it2;
     }
@@ -726,10 +768,10 @@ series<T>::operator*(const series<U>& other) const
 {
     using V = decltype(std::declval<T>() * std::declval<U>());
     series<V> result;
-    auto it1 = m_sharedvec->begin();
-    auto it2 = other.m_sharedvec->begin();
-    while (it1 != m_sharedvec->end() && it2 != other.m_sharedvec->end()) {
-        result.m_sharedvec->push_back(*it1 * *it2);
+    auto it1 = cvec().begin();
+    auto it2 = other.cvec().begin();
+    while (it1 != cvec().end() && it2 != other.cvec().end()) {
+        result.push_back(*it1 * *it2);
         ++it1;
         ++it2;
     }
@@ -743,10 +785,10 @@ series<T>::operator/(const series<U>& other) const
 {
     using V = decltype(std::declval<T>() / std::declval<U>());
     series<V> result;
-    auto it1 = m_sharedvec->begin();
-    auto it2 = other.m_sharedvec->begin();
-    while (it1 != m_sharedvec->end() && it2 != other.m_sharedvec->end()) {
-        result.m_sharedvec->push_back(*it1 / *it2);
+    auto it1 = cvec().begin();
+    auto it2 = other.cvec().begin();
+    while (it1 != cvec().end() && it2 != other.cvec().end()) {
+        result.push_back(*it1 / *it2);
         ++it1;
         ++it2;
     }
@@ -760,10 +802,10 @@ series<T>::operator%(const series<U>& other) const
 {
     using V = decltype(std::declval<T>() % std::declval<U>());
     series<V> result;
-    auto it1 = m_sharedvec->begin();
-    auto it2 = other.m_sharedvec->begin();
-    while (it1 != m_sharedvec->end() && it2 != other.m_sharedvec->end()) {
-        result.m_sharedvec->push_back(*it1 % *it2);
+    auto it1 = cvec().begin();
+    auto it2 = other.cvec().begin();
+    while (it1 != cvec().end() && it2 != other.cvec().end()) {
+        result.push_back(*it1 % *it2);
         ++it1;
         ++it2;
     }
@@ -798,6 +840,7 @@ template<typename T>
 void
 series<T>::reserve(size_t _size)
 {
+    unref();
     m_sharedvec->reserve(_size);
 }
 
@@ -805,7 +848,7 @@ template<typename T>
 void
 series<T>::resize(size_t newsize)
 {
-    if (newsize != m_sharedvec->size()) {
+    if (newsize != cvec().size()) {
         unref();
         m_sharedvec->resize(newsize);
     }
@@ -815,12 +858,30 @@ template<typename T>
 void
 series<T>::resize(size_t newsize, const T& value)
 {
-    if (newsize != m_sharedvec->size()) {
+    if (newsize != cvec().size()) {
         unref();
         m_sharedvec->resize(newsize, value);
     }
 }
 
+template<typename T>
+void
+series<T>::reverse_sort()
+{
+    if (size() > 1) {
+        detail::sort_values<true>(data(), size());
+    }
+}
+
+template<typename T>
+series<T>
+series<T>::reverse_sorted() const
+{
+    series out{ *this };
+    out.reverse_sort();
+    return out;
+}
+
 template<typename T>
 void
 series<T>::set_name(const std::string& name)
@@ -832,14 +893,51 @@ template<typename T>
 void
 series<T>::shrink_to_fit()
 {
-    m_sharedvec->shrink_to_fit();
+    if (m_sharedvec && m_sharedvec.use_count() == 1) {
+        m_sharedvec->shrink_to_fit();
+    }
 }
 
 template<typename T>
 size_t
 series<T>::size() const
 {
-    return m_sharedvec->size();
+    return cvec().size();
+}
+
+template<typename T>
+series<T>
+series<T>::slice(size_t begin, size_t end) const
+{
+    if (begin > end || end > size()) {
+        throw std::out_of_range{ "slice() of [" + std::to_string(begin) + ", " +
+            std::to_string(end) + ") but size() is " + std::to_string(size()) };
+    }
+    series out;
+    out.m_name = m_name;
+    if (begin != end) {
+        const T* d      = m_sharedvec->data();
+        out.m_sharedvec = std::make_shared<series_vector<T>>(m_sharedvec, d + begin, d + end);
+    }
+    return out;
+}
+
+template<typename T>
+void
+series<T>::sort()
+{
+    if (size() > 1) {
+        detail::sort_values<false>(data(), size());
+    }
+}
+
+template<typename T>
+series<T>
+series<T>::sorted() const
+{
+    series out{ *this };
+    out.sort();
+    return out;
 }
 
 template<typename T>
@@ -857,7 +955,7 @@ series<T>::to_string() const
     std::vector<std::string> s;
     s.reserve(size());
 
-    for (const T& t : *m_sharedvec) {
+    for (const T& t : cvec()) {
         std::stringstream ss;
         ss << std::boolalpha;
         detail::stringify(ss, t, true);
@@ -872,7 +970,7 @@ series<T>::unique() const
 {
     series out;
     out.m_name      = m_name;
-    out.m_sharedvec = m_sharedvec->unique();
+    out.m_sharedvec = cvec().unique();
     return out;
 }
 
@@ -880,14 +978,18 @@ template<typename T>
 size_t
 series<T>::use_count() const
 {
-    return m_sharedvec.use_count();
+    // An empty series with no storage owns nothing it could share
+    return m_sharedvec ? m_sharedvec.use_count() : 1;
 }
 
 template<typename T>
 void
 series<T>::unref()
 {
-    if (m_sharedvec.use_count() > 1) {
+    if (!m_sharedvec) {
+        m_sharedvec = std::make_shared<series_vector<T>>(m_resource);
+    }
+    else if (m_sharedvec.use_count() > 1 || m_sharedvec->borrowed()) {
         std::shared_ptr<series_vector<T>> n = std::make_shared<series_vector<T>>(*m_sharedvec);
         m_sharedvec                         = n;
     }
@@ -895,32 +997,34 @@ series<T>::unref()
 
 // ================= private =================
 
+template<typename T>
+const detail::series_vector<T>&
+series<T>::cvec() const
+{
+    // Stands in for the storage of a series that hasn't allocated any yet.
+    // It's never handed out mutably, so every series<T> can share it. It
+    // mustn't pick up whatever default resource is current on first use,
+    // which could be an arena.
+    static const detail::series_vector<T> empty(aligned_heap_resource());
+    return m_sharedvec ? *m_sharedvec : empty;
+}
+
 template<typename T>
 typename series<T>::iterator
 series<T>::unref(typename series<T>::iterator it)
 {
-    typename series<T>::iterator newit = it;
-    if (m_sharedvec.use_count() > 1) {
-        auto oldbegin                       = m_sharedvec->begin();
-        std::shared_ptr<series_vector<T>> n = std::make_shared<series_vector<T>>(*m_sharedvec);
-        m_sharedvec                         = n;
-        newit += (m_sharedvec->begin() - oldbegin);
-    }
-    return newit;
+    auto offset = it.data() - cvec().data();
+    unref();
+    return m_sharedvec->begin() + offset;
 }
 
 template<typename T>
 typename series<T>::const_iterator
 series<T>::unref(typename series<T>::const_iterator it)
 {
-    typename series<T>::const_iterator newit = it;
-    if (m_sharedvec.use_count() > 1) {
-        auto oldbegin                       = m_sharedvec->cbegin();
-        std::shared_ptr<series_vector<T>> n = std::make_shared<series_vector<T>>(*m_sharedvec);
-        m_sharedvec                         = n;
-        newit += (m_sharedvec->cbegin() - oldbegin);
-    }
-    return newit;
+    auto offset = it.data() - cvec().data();
+    unref();
+    return m_sharedvec->cbegin() + offset;
 }
 
 
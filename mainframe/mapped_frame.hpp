@@ -0,0 +1,176 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_mapped_frame_h
+#define INCLUDED_mainframe_mapped_frame_h
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "mainframe/detail/column_file.hpp"
+#include "mainframe/frame.hpp"
+
+namespace mf
+{
+
+namespace detail
+{
+
+template<typename... Ts, size_t... Inds>
+std::vector<column_desc>
+describe_columns(const frame<Ts...>& f, std::index_sequence<Inds...>)
+{
+    return { column_desc{ f.column(columnindex<Inds>{}).name(), sizeof(Ts),
+        f.column(columnindex<Inds>{}).data() }... };
+}
+
+template<size_t Ind, typename... Ts>
+void
+borrow_column(frame<Ts...>& f, const std::shared_ptr<const void>& owner,
+    const std::vector<column_desc>& cols, size_t num_rows, const std::string& source)
+{
+    using T = typename pack_element<Ind, Ts...>::type;
+    if (cols[Ind].elem_size != sizeof(T)) {
+        throw std::runtime_error{ source + " column " + std::to_string(Ind) + " has " +
+            std::to_string(cols[Ind].elem_size) + "-byte elements, expected " +
+            std::to_string(sizeof(T)) };
+    }
+    series<T>& s = f.column(columnindex<Ind>{});
+    if (num_rows > 0) {
+        const T* first = static_cast<const T*>(cols[Ind].data);
+        s              = series<T>{ owner, first, first + num_rows };
+    }
+    s.set_name(cols[Ind].name);
+    if constexpr (Ind + 1 < sizeof...(Ts)) {
+        borrow_column<Ind + 1>(f, owner, cols, num_rows, source);
+    }
+}
+
+// A frame whose columns point into the column file at p, which owner
+// keeps alive
+template<typename... Ts>
+frame<Ts...>
+borrow_frame(std::shared_ptr<const void> owner, const char* p, size_t size,
+    const std::string& source)
+{
+    size_t num_rows = 0;
+    std::vector<column_desc> cols = parse_columns(p, size, num_rows, source);
+    if (cols.size() != sizeof...(Ts)) {
+        throw std::runtime_error{ source + " has " + std::to_string(cols.size()) +
+            " columns, expected " + std::to_string(sizeof...(Ts)) };
+    }
+    frame<Ts...> out;
+    borrow_column<0>(out, owner, cols, num_rows, source);
+    return out;
+}
+
+} // namespace detail
+
+///
+/// Save a frame as a column file that map_frame() can open. Each column is
+/// written as a raw array, so every column type must be trivially
+/// copyable - numbers, dates, times, or mi<>/smi<> of these.
+///
+///     frame<year_month_day, double, int> f;
+///     ...
+///     write_frame(f, "/data/reference.mf");
+///
+template<typename... Ts>
+void
+write_frame(const frame<Ts...>& f, const std::string& path)
+{
+    static_assert((std::is_trivially_copyable<Ts>::value && ...),
+        "write_frame() needs trivially copyable column types");
+    detail::write_column_file(
+        path, detail::describe_columns(f, std::index_sequence_for<Ts...>{}), f.size());
+}
+
+///
+/// Open a file written by write_frame() without reading it. The file is
+/// mapped read-only and each column is a view straight into the mapping,
+/// so opening takes the same time for any size of file, pages are only
+/// read from disk as they are used, and every process that maps the file
+/// shares one copy of it in the page cache.
+///
+///     auto f = map_frame<year_month_day, double, int>("/data/reference.mf");
+///     double avg = f.mean(_1);        // reads the file through the mapping
+///     f.column(_1)[0] = 0.0;          // copies column 1 into the heap first
+///
+/// Columns are copy-on-write: the first modification of a column copies it
+/// into ordinary heap storage, leaving the file untouched. The mapping
+/// stays alive as long as any series still points into it. Column types
+/// must match the ones the file was written with; the number of columns
+/// and each element size are checked, and std::runtime_error is thrown if
+/// they differ or the file is malformed.
+///
+template<typename... Ts>
+frame<Ts...>
+map_frame(const std::string& path)
+{
+    static_assert((std::is_trivially_copyable<Ts>::value && ...),
+        "map_frame() needs trivially copyable column types");
+    auto file = std::make_shared<const detail::mapped_file>(path);
+    return detail::borrow_frame<Ts...>(file, file->data(), file->size(), path);
+}
+
+///
+/// Copy a frame into a POSIX shared memory object called name, e.g.
+/// "/reference", replacing any frame already published under that name.
+/// Other processes on the machine can then attach_frame() to it and share
+/// the one copy instead of each loading their own. Like write_frame(),
+/// every column type must be trivially copyable.
+///
+///     // loader process
+///     publish_frame(load_reference_data(), "/reference");
+///
+///     // worker processes
+///     auto ref = attach_frame<year_month_day, double, int>("/reference");
+///
+/// Processes attached to a frame that is republished keep the frame they
+/// attached to until they attach again. The object persists until
+/// unpublish_frame() is called or the machine restarts.
+///
+template<typename... Ts>
+void
+publish_frame(const frame<Ts...>& f, const std::string& name)
+{
+    static_assert((std::is_trivially_copyable<Ts>::value && ...),
+        "publish_frame() needs trivially copyable column types");
+    detail::publish_column_file(
+        name, detail::describe_columns(f, std::index_sequence_for<Ts...>{}), f.size());
+}
+
+///
+/// Map a frame published with publish_frame() read-only into this process.
+/// Like map_frame(), columns are views straight into the shared memory
+/// and are copied into the heap when first modified, and the column types
+/// are checked against the ones the frame was published with.
+///
+template<typename... Ts>
+frame<Ts...>
+attach_frame(const std::string& name)
+{
+    static_assert((std::is_trivially_copyable<Ts>::value && ...),
+        "attach_frame() needs trivially copyable column types");
+    auto shm =
+        std::make_shared<const detail::mapped_file>(detail::mapped_file::shared_memory, name);
+    return detail::borrow_frame<Ts...>(shm, shm->data(), shm->size(), name);
+}
+
+/// Remove the shared memory object created by publish_frame(). Processes
+/// that are attached to it keep their mapping.
+inline void
+unpublish_frame(const std::string& name)
+{
+    detail::unpublish_column_file(name);
+}
+
+} // namespace mf
+
+
+#endif // INCLUDED_mainframe_mapped_frame_h
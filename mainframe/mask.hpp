@@ -0,0 +1,337 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_mask_h
+#define INCLUDED_mainframe_mask_h
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mainframe/series.hpp"
+
+namespace mf
+{
+
+///
+/// mask class
+///
+/// A bit-packed boolean column, one bit per row, used to select rows of a
+/// @ref frame. A predicate can be evaluated once with frame::make_mask(),
+/// combined with other masks a 64-bit word at a time and then applied to
+/// any number of frames of the same length with frame::filter().
+///
+///     mask warm = f.make_mask(_1 > 20.0);
+///     mask dry  = f.make_mask(_2 == false);
+///     auto nice = f.filter(warm & dry);
+///     auto temp = f.columns(_0, _1).filter(warm & ~dry);
+///
+/// At one bit per element it is also an 8x smaller alternative to
+/// series<bool> for storing boolean data; see the series<bool> constructor
+/// and to_series().
+///
+class mask
+{
+    static constexpr size_t word_bits = 64;
+
+public:
+    mask() = default;
+
+    explicit mask(size_t count, bool value = false)
+        : m_words(words_for(count), value ? ~uint64_t{ 0 } : 0)
+        , m_size(count)
+    {
+        clear_tail();
+    }
+
+    mask(std::initializer_list<bool> init)
+    {
+        reserve(init.size());
+        for (bool b : init) {
+            push_back(b);
+        }
+    }
+
+    explicit mask(const series<bool>& s)
+    {
+        reserve(s.size());
+        for (bool b : s) {
+            push_back(b);
+        }
+    }
+
+    bool
+    all() const
+    {
+        return count() == m_size;
+    }
+
+    bool
+    any() const
+    {
+        for (uint64_t w : m_words) {
+            if (w != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Append count copies of value, filling whole words at a time
+    void
+    append(size_t count, bool value)
+    {
+        size_t first = m_size;
+        m_size += count;
+        m_words.resize(words_for(m_size), 0);
+        if (!value) {
+            return;
+        }
+        for (size_t w = first / word_bits; w < m_words.size(); ++w) {
+            size_t lo     = std::max(first, w * word_bits) - w * word_bits;
+            size_t hi     = std::min(m_size, (w + 1) * word_bits) - w * word_bits;
+            uint64_t high = hi == word_bits ? ~uint64_t{ 0 } : (uint64_t{ 1 } << hi) - 1;
+            m_words[w] |= high & ~((uint64_t{ 1 } << lo) - 1);
+        }
+    }
+
+    bool
+    at(size_t n) const
+    {
+        if (n >= m_size) {
+            throw std::out_of_range{ "size() is " + std::to_string(m_size) + ", pos is " +
+                std::to_string(n) };
+        }
+        return (*this)[n];
+    }
+
+    void
+    clear()
+    {
+        m_words.clear();
+        m_size = 0;
+    }
+
+    /// The number of set bits
+    size_t
+    count() const
+    {
+        size_t out = 0;
+        for (uint64_t w : m_words) {
+            out += detail::popcount64(w);
+        }
+        return out;
+    }
+
+    const uint64_t*
+    data() const
+    {
+        return m_words.data();
+    }
+
+    /// The words themselves, for filling a mask a word at a time. Bits past
+    /// size() in the last word must be left clear
+    uint64_t*
+    data()
+    {
+        return m_words.data();
+    }
+
+    bool
+    empty() const
+    {
+        return m_size == 0;
+    }
+
+    /// Call f(n) for each set bit n, in increasing order
+    template<typename F>
+    void
+    for_each_set(F&& f) const
+    {
+        for (size_t w = 0; w < m_words.size(); ++w) {
+            uint64_t bits = m_words[w];
+            while (bits != 0) {
+                f(w * word_bits + detail::ctz64(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    bool
+    none() const
+    {
+        return !any();
+    }
+
+    bool
+    operator[](size_t n) const
+    {
+        return (m_words[n / word_bits] >> (n % word_bits)) & 1;
+    }
+
+    mask&
+    operator&=(const mask& other)
+    {
+        check_size(other);
+        for (size_t i = 0; i < m_words.size(); ++i) {
+            m_words[i] &= other.m_words[i];
+        }
+        return *this;
+    }
+
+    mask&
+    operator|=(const mask& other)
+    {
+        check_size(other);
+        for (size_t i = 0; i < m_words.size(); ++i) {
+            m_words[i] |= other.m_words[i];
+        }
+        return *this;
+    }
+
+    mask&
+    operator^=(const mask& other)
+    {
+        check_size(other);
+        for (size_t i = 0; i < m_words.size(); ++i) {
+            m_words[i] ^= other.m_words[i];
+        }
+        return *this;
+    }
+
+    mask
+    operator&(const mask& other) const
+    {
+        mask out{ *this };
+        out &= other;
+        return out;
+    }
+
+    mask
+    operator|(const mask& other) const
+    {
+        mask out{ *this };
+        out |= other;
+        return out;
+    }
+
+    mask
+    operator^(const mask& other) const
+    {
+        mask out{ *this };
+        out ^= other;
+        return out;
+    }
+
+    mask
+    operator~() const
+    {
+        mask out{ *this };
+        for (uint64_t& w : out.m_words) {
+            w = ~w;
+        }
+        out.clear_tail();
+        return out;
+    }
+
+    bool
+    operator==(const mask& other) const
+    {
+        return m_size == other.m_size && m_words == other.m_words;
+    }
+
+    bool
+    operator!=(const mask& other) const
+    {
+        return !(*this == other);
+    }
+
+    void
+    push_back(bool value)
+    {
+        if (m_size % word_bits == 0) {
+            m_words.push_back(0);
+        }
+        if (value) {
+            m_words.back() |= uint64_t{ 1 } << (m_size % word_bits);
+        }
+        ++m_size;
+    }
+
+    void
+    reserve(size_t n)
+    {
+        m_words.reserve(words_for(n));
+    }
+
+    void
+    set(size_t n, bool value = true)
+    {
+        if (n >= m_size) {
+            throw std::out_of_range{ "size() is " + std::to_string(m_size) + ", pos is " +
+                std::to_string(n) };
+        }
+        uint64_t bit = uint64_t{ 1 } << (n % word_bits);
+        if (value) {
+            m_words[n / word_bits] |= bit;
+        }
+        else {
+            m_words[n / word_bits] &= ~bit;
+        }
+    }
+
+    size_t
+    size() const
+    {
+        return m_size;
+    }
+
+    series<bool>
+    to_series() const
+    {
+        series<bool> out;
+        out.reserve(m_size);
+        for (size_t i = 0; i < m_size; ++i) {
+            out.push_back((*this)[i]);
+        }
+        return out;
+    }
+
+private:
+    void
+    check_size(const mask& other) const
+    {
+        if (m_size != other.m_size) {
+            throw std::invalid_argument{ "masks have different sizes" };
+        }
+    }
+
+    // Bits past size() are kept clear so that count() and operator== can
+    // work on whole words
+    void
+    clear_tail()
+    {
+        size_t rem = m_size % word_bits;
+        if (rem != 0) {
+            m_words.back() &= (uint64_t{ 1 } << rem) - 1;
+        }
+    }
+
+    static size_t
+    words_for(size_t n)
+    {
+        return (n + word_bits - 1) / word_bits;
+    }
+
+    std::vector<uint64_t> m_words;
+    size_t m_size = 0;
+};
+
+} // namespace mf
+
+
+#endif // INCLUDED_mainframe_mask_h
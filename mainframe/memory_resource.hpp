@@ -0,0 +1,317 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_memory_resource_h
+#define INCLUDED_mainframe_memory_resource_h
+
+#include <cstddef>
+
+namespace mf
+{
+
+/// Every column buffer handed out to a series is aligned to at least this
+/// many bytes - one cache line, and wide enough for aligned AVX/AVX-512 loads.
+inline constexpr size_t column_alignment = 64;
+
+///
+/// memory_resource class
+///
+/// The allocation interface behind every @ref series buffer. It mirrors
+/// std::pmr::memory_resource: derive from it, implement do_allocate() and
+/// do_deallocate(), and hand a pointer to the series (or frame) constructor,
+/// or install it process-wide with set_default_resource(). This lets pool,
+/// arena or huge-page allocators back the columns without touching the
+/// library.
+///
+///     class counting_resource : public mf::memory_resource
+///     {
+///     protected:
+///         void* do_allocate(size_t bytes, size_t alignment) override;
+///         void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+///     };
+///
+///     counting_resource res;
+///     series<double> s(&res);
+///
+/// series_vector always asks for at least column_alignment, so a resource
+/// must honour the requested alignment.
+///
+class memory_resource
+{
+public:
+    virtual ~memory_resource() = default;
+
+    void*
+    allocate(size_t bytes, size_t alignment = column_alignment)
+    {
+        return do_allocate(bytes, alignment);
+    }
+
+    void
+    deallocate(void* p, size_t bytes, size_t alignment = column_alignment)
+    {
+        do_deallocate(p, bytes, alignment);
+    }
+
+    /// Grow or shrink a block from allocate(), preserving the first
+    /// min(old_bytes, new_bytes) bytes. Only valid for trivially copyable
+    /// contents since the bytes may be moved with memcpy or by the kernel.
+    void*
+    reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment = column_alignment)
+    {
+        return do_reallocate(p, old_bytes, new_bytes, alignment);
+    }
+
+    bool
+    is_equal(const memory_resource& other) const noexcept
+    {
+        return this == &other || do_is_equal(other);
+    }
+
+protected:
+    virtual void*
+    do_allocate(size_t bytes, size_t alignment) = 0;
+
+    virtual void
+    do_deallocate(void* p, size_t bytes, size_t alignment) = 0;
+
+    virtual void*
+    do_reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment);
+
+    virtual bool
+    do_is_equal(const memory_resource& other) const noexcept
+    {
+        return this == &other;
+    }
+};
+
+/// The library's built-in resource, aligned operator new/delete
+memory_resource*
+aligned_heap_resource() noexcept;
+
+///
+/// huge_page_resource class
+///
+/// A memory_resource for large columns. Blocks of at least threshold bytes
+/// are mapped directly, backed by 2MiB huge pages and placed on NUMA nodes
+/// according to the options; smaller blocks come from upstream. Huge pages
+/// cut the TLB misses of scanning a large column, and node placement keeps
+/// a column near the threads that read it instead of wherever the thread
+/// that filled it happened to run.
+///
+///     huge_page_resource::options opts;
+///     opts.placement = numa_placement::interleave;
+///     huge_page_resource big(opts);
+///     frame<year_month_day, double, double> f(&big);
+///
+/// huge_pages::transparent asks for transparent huge pages with
+/// madvise(MADV_HUGEPAGE), and huge_pages::none opts out of them so that
+/// only the placement applies. huge_pages::hugetlb maps from the explicit
+/// hugetlbfs pool (vm.nr_hugepages) and falls back to transparent huge
+/// pages when the pool is empty. Placement uses the mbind() system call
+/// directly, so no libnuma is needed; like the huge page requests it is
+/// advisory and silently does nothing where the kernel refuses it. On
+/// systems other than Linux every block comes from upstream.
+///
+/// Large blocks are whole huge pages, so growing one copies it. Reserve
+/// large columns up front where the final size is known.
+///
+enum class huge_pages
+{
+    none,
+    transparent,
+    hugetlb
+};
+
+enum class numa_placement
+{
+    any,        // the kernel's default, usually the node that first touches a page
+    local,      // the node of the thread that allocates the column
+    interleave, // round-robin across every node this process may use
+    node        // the node given in options::node
+};
+
+class huge_page_resource : public memory_resource
+{
+public:
+    struct options
+    {
+        size_t threshold         = size_t{ 2 } << 20;
+        huge_pages pages         = huge_pages::transparent;
+        numa_placement placement = numa_placement::any;
+        int node                 = 0;
+    };
+
+    huge_page_resource() noexcept;
+    explicit huge_page_resource(
+        const options& opts, memory_resource* upstream = aligned_heap_resource()) noexcept;
+
+    const options&
+    get_options() const noexcept
+    {
+        return m_options;
+    }
+
+protected:
+    void*
+    do_allocate(size_t bytes, size_t alignment) override;
+
+    void
+    do_deallocate(void* p, size_t bytes, size_t alignment) override;
+
+    void*
+    do_reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment) override;
+
+private:
+    bool
+    is_large(size_t bytes) const noexcept;
+
+    options m_options;
+    memory_resource* m_upstream;
+};
+
+///
+/// arena_resource class
+///
+/// A monotonic "bump" allocator: blocks are carved one after another out
+/// of large chunks from upstream, deallocate() does nothing (except give
+/// back the most recent block), and everything is returned to upstream at
+/// once by release() or the destructor. Growing the most recent block
+/// extends it in place, so a column filled by push_back() inside an arena
+/// rarely copies. See @ref arena_scope for the usual way to use one.
+///
+class arena_resource : public memory_resource
+{
+public:
+    static constexpr size_t default_chunk_size = size_t{ 64 } << 10;
+
+    explicit arena_resource(size_t chunk_size   = default_chunk_size,
+        memory_resource* upstream = aligned_heap_resource()) noexcept;
+    ~arena_resource() override;
+
+    arena_resource(const arena_resource&) = delete;
+    arena_resource&
+    operator=(const arena_resource&) = delete;
+
+    /// Bytes handed out since construction or the last release()
+    size_t
+    bytes_used() const noexcept
+    {
+        return m_used;
+    }
+
+    /// Return every chunk to upstream. Anything allocated from the arena
+    /// must already be gone.
+    void
+    release() noexcept;
+
+protected:
+    void*
+    do_allocate(size_t bytes, size_t alignment) override;
+
+    void
+    do_deallocate(void* p, size_t bytes, size_t alignment) override;
+
+    void*
+    do_reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t alignment) override;
+
+private:
+    struct chunk
+    {
+        chunk* prev;
+        size_t size;
+    };
+
+    chunk* m_chunks = nullptr;
+    char* m_cur     = nullptr;
+    char* m_end     = nullptr;
+    char* m_last    = nullptr; // the most recent block
+    size_t m_used   = 0;
+    size_t m_next_chunk_size;
+    memory_resource* m_upstream;
+};
+
+/// The resource used by series that aren't given one explicitly: the
+/// innermost @ref arena_scope on this thread if there is one, otherwise
+/// the process-wide default
+memory_resource*
+get_default_resource() noexcept;
+
+/// Replace the default resource and return the previous one. Passing nullptr
+/// restores aligned_heap_resource().
+memory_resource*
+set_default_resource(memory_resource* resource) noexcept;
+
+namespace detail
+{
+// Make resource the default for this thread only, or clear the override
+// with nullptr, and return the previous override. Used by arena_scope
+memory_resource*
+exchange_thread_resource(memory_resource* resource) noexcept;
+} // namespace detail
+
+///
+/// How a series grows its buffer when it runs out of room.
+///
+/// power_of_two (the default) rounds every allocation up to a power of two,
+/// so appends are cheap but a column can hold almost twice its size.
+/// factor_1_5 grows by half the current capacity, trading a few more
+/// reallocations for at most 50% slack. exact allocates only what is asked
+/// for, which suits frames that are sized with reserve() or loaded in bulk
+/// but makes repeated push_back() reallocate every time.
+///
+enum class growth_policy
+{
+    power_of_two,
+    factor_1_5,
+    exact
+};
+
+/// The policy used by every series when it grows
+growth_policy
+get_growth_policy() noexcept;
+
+/// Replace the growth policy and return the previous one. Buffers that are
+/// already allocated keep their capacity until they next grow or are
+/// compacted with shrink_to_fit().
+growth_policy
+set_growth_policy(growth_policy policy) noexcept;
+
+///
+/// memory_stats struct
+///
+/// The bytes behind a series or frame, as reported by memory_usage().
+///
+///     memory_stats m = f.memory_usage();
+///     size_t slack   = m.capacity_bytes - m.logical_bytes;
+///     size_t owned   = m.capacity_bytes - m.shared_bytes + m.out_of_line_bytes;
+///
+/// capacity_bytes counts every buffer in full, including those that are
+/// shared with other series through copy-on-write or slice(); shared_bytes
+/// is the part of capacity_bytes that would stay allocated if this series
+/// were destroyed. out_of_line_bytes is memory the elements themselves
+/// point to, such as the heap buffers of long std::strings.
+///
+struct memory_stats
+{
+    size_t logical_bytes     = 0;
+    size_t capacity_bytes    = 0;
+    size_t shared_bytes      = 0;
+    size_t out_of_line_bytes = 0;
+
+    memory_stats&
+    operator+=(const memory_stats& other) noexcept
+    {
+        logical_bytes += other.logical_bytes;
+        capacity_bytes += other.capacity_bytes;
+        shared_bytes += other.shared_bytes;
+        out_of_line_bytes += other.out_of_line_bytes;
+        return *this;
+    }
+};
+
+} // namespace mf
+
+
+#endif // INCLUDED_mainframe_memory_resource_h
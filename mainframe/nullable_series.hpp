@@ -0,0 +1,426 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_nullable_series_h
+#define INCLUDED_mainframe_nullable_series_h
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mainframe/detail/simd.hpp"
+#include "mainframe/missing.hpp"
+#include "mainframe/series.hpp"
+
+namespace mf
+{
+
+///
+/// nullable_series class
+///
+/// A column of mi<T> stored as two parallel arrays: the dense T values and a
+/// packed validity bitmap with one bit per element. A series<mi<T>> keeps
+/// each element's flag next to its value, which roughly doubles the size of
+/// numeric columns and stops the kernels in detail/simd.hpp from running over
+/// them. Here the values stay contiguous, so aggregations walk the bitmap 64
+/// elements at a time and hand each run of present values to the same dense
+/// kernels a series<T> uses.
+///
+///     nullable_series<double> px{ 1.0, missing, 3.0 };
+///     px.count();          // 2
+///     px.mean();           // 2.0
+///     px.fill_forward();   // 1.0, 1.0, 3.0
+///     px.drop_missing();   // series<double>{ 1.0, 3.0 }
+///
+/// Missing slots hold a default-constructed T. allow_missing() converts to
+/// a series<mi<T>>, and the series<mi<T>> constructor converts back.
+///
+template<typename T>
+class nullable_series
+{
+    static constexpr size_t word_bits = 64;
+
+public:
+    using value_type = mi<T>;
+    using size_type  = size_t;
+
+    nullable_series() = default;
+
+    /// All elements present
+    explicit nullable_series(const series<T>& s)
+        : m_values(s)
+        , m_validity(words_for(s.size()), ~uint64_t{ 0 })
+    {
+        clear_tail();
+    }
+
+    explicit nullable_series(const series<mi<T>>& s)
+    {
+        reserve(s.size());
+        for (const mi<T>& v : s) {
+            push_back(v);
+        }
+        m_values.set_name(s.name());
+    }
+
+    nullable_series(std::initializer_list<mi<T>> init)
+    {
+        reserve(init.size());
+        for (const mi<T>& v : init) {
+            push_back(v);
+        }
+    }
+
+    /// Convert to the interleaved series<mi<T>> layout
+    series<mi<T>>
+    allow_missing() const
+    {
+        series<mi<T>> out;
+        out.reserve(size());
+        for (size_t i = 0; i < size(); ++i) {
+            out.push_back((*this)[i]);
+        }
+        out.set_name(name());
+        return out;
+    }
+
+    mi<T>
+    at(size_t n) const
+    {
+        if (n >= size()) {
+            throw std::out_of_range{ "size() is " + std::to_string(size()) + ", pos is " +
+                std::to_string(n) };
+        }
+        return (*this)[n];
+    }
+
+    void
+    clear()
+    {
+        m_values.clear();
+        m_validity.clear();
+    }
+
+    /// The number of elements that aren't missing
+    size_t
+    count() const
+    {
+        size_t out = 0;
+        for (uint64_t w : m_validity) {
+            out += detail::popcount64(w);
+        }
+        return out;
+    }
+
+    size_t
+    count_missing() const
+    {
+        return size() - count();
+    }
+
+    /// The values with missing elements replaced by T{}, as
+    /// series<mi<T>>::disallow_missing() does. Doesn't copy the values.
+    series<T>
+    disallow_missing() const
+    {
+        return m_values;
+    }
+
+    /// The values that aren't missing, in order
+    series<T>
+    drop_missing() const
+    {
+        series<T> out;
+        out.reserve(count());
+        const T* vals = m_values.data();
+        for_each_run([&](size_t first, size_t len) {
+            out.insert(out.cend(), vals + first, vals + first + len);
+        });
+        out.set_name(name());
+        return out;
+    }
+
+    bool
+    empty() const
+    {
+        return m_values.empty();
+    }
+
+    /// Replace each missing element with the closest present element before
+    /// it. Leading missing elements stay missing.
+    nullable_series
+    fill_forward() const
+    {
+        nullable_series out{ *this };
+        if (empty()) {
+            return out;
+        }
+        size_t first = find_first_valid();
+        if (first == size()) {
+            return out;
+        }
+        T* vals = out.m_values.data();
+        for (size_t w = first / word_bits; w < m_validity.size(); ++w) {
+            uint64_t bits = m_validity[w];
+            if (bits == ~uint64_t{ 0 }) {
+                continue;
+            }
+            size_t base = w * word_bits;
+            size_t end  = std::min(base + word_bits, size());
+            for (size_t i = std::max(base, first + 1); i < end; ++i) {
+                if (!((bits >> (i - base)) & 1)) {
+                    vals[i] = vals[i - 1];
+                }
+            }
+            out.m_validity[w] = ~uint64_t{ 0 };
+        }
+        // Leading missing elements remain missing
+        for (size_t i = 0; i < first; ++i) {
+            out.m_validity[i / word_bits] &= ~(uint64_t{ 1 } << (i % word_bits));
+        }
+        out.clear_tail();
+        return out;
+    }
+
+    bool
+    is_missing(size_t n) const
+    {
+        return !((m_validity[n / word_bits] >> (n % word_bits)) & 1);
+    }
+
+    double
+    mean() const
+    {
+        size_t num = 0;
+        double sum = 0.0;
+        const T* vals = m_values.data();
+        for_each_run([&](size_t first, size_t len) {
+            sum += detail::mean(vals + first, len) * len;
+            num += len;
+        });
+        return sum / num;
+    }
+
+    /// The minimum and maximum of the elements that aren't missing. Both are
+    /// missing if every element is.
+    std::pair<mi<T>, mi<T>>
+    minmax() const
+    {
+        std::pair<mi<T>, mi<T>> out;
+        const T* vals = m_values.data();
+        for_each_run([&](size_t first, size_t len) {
+            auto [mn, mx] = std::minmax_element(vals + first, vals + first + len);
+            if (!out.first.has_value()) {
+                out = { mi<T>{ *mn }, mi<T>{ *mx } };
+            }
+            else {
+                out.first  = std::min(*out.first, *mn);
+                out.second = std::max(*out.second, *mx);
+            }
+        });
+        return out;
+    }
+
+    const std::string&
+    name() const
+    {
+        return m_values.name();
+    }
+
+    mi<T>
+    operator[](size_t n) const
+    {
+        if (is_missing(n)) {
+            return missing;
+        }
+        return m_values[n];
+    }
+
+    bool
+    operator==(const nullable_series& other) const
+    {
+        if (name() != other.name() || size() != other.size() ||
+            m_validity != other.m_validity) {
+            return false;
+        }
+        bool eq = true;
+        const T* a = m_values.data();
+        const T* b = other.m_values.data();
+        for_each_run([&](size_t first, size_t len) {
+            eq = eq && std::equal(a + first, a + first + len, b + first);
+        });
+        return eq;
+    }
+
+    bool
+    operator!=(const nullable_series& other) const
+    {
+        return !(*this == other);
+    }
+
+    void
+    push_back(const mi<T>& value)
+    {
+        size_t n = size();
+        if (n % word_bits == 0) {
+            m_validity.push_back(0);
+        }
+        if (value.has_value()) {
+            m_values.push_back(*value);
+            m_validity.back() |= uint64_t{ 1 } << (n % word_bits);
+        }
+        else {
+            m_values.push_back(T{});
+        }
+    }
+
+    void
+    reserve(size_t n)
+    {
+        m_values.reserve(n);
+        m_validity.reserve(words_for(n));
+    }
+
+    void
+    set(size_t n, const mi<T>& value)
+    {
+        if (n >= size()) {
+            throw std::out_of_range{ "size() is " + std::to_string(size()) + ", pos is " +
+                std::to_string(n) };
+        }
+        uint64_t bit = uint64_t{ 1 } << (n % word_bits);
+        if (value.has_value()) {
+            m_values[n] = *value;
+            m_validity[n / word_bits] |= bit;
+        }
+        else {
+            m_values[n] = T{};
+            m_validity[n / word_bits] &= ~bit;
+        }
+    }
+
+    void
+    set_name(const std::string& name)
+    {
+        m_values.set_name(name);
+    }
+
+    size_t
+    size() const
+    {
+        return m_values.size();
+    }
+
+    /// The sum of the elements that aren't missing
+    T
+    sum() const
+    {
+        T out{};
+        const T* vals = m_values.data();
+        for_each_run([&](size_t first, size_t len) {
+            for (size_t i = first; i < first + len; ++i) {
+                out += vals[i];
+            }
+        });
+        return out;
+    }
+
+    /// The packed validity bitmap; bit i % 64 of word i / 64 is set when
+    /// element i is present. Bits past size() are always clear.
+    const uint64_t*
+    validity() const
+    {
+        return m_validity.data();
+    }
+
+    /// The dense values, with T{} in the missing slots
+    const T*
+    values() const
+    {
+        return m_values.data();
+    }
+
+private:
+    void
+    clear_tail()
+    {
+        size_t rem = size() % word_bits;
+        if (rem != 0) {
+            m_validity.back() &= (uint64_t{ 1 } << rem) - 1;
+        }
+    }
+
+    size_t
+    find_first_valid() const
+    {
+        for (size_t w = 0; w < m_validity.size(); ++w) {
+            if (m_validity[w] != 0) {
+                return w * word_bits + detail::ctz64(m_validity[w]);
+            }
+        }
+        return size();
+    }
+
+    // Call f(first, len) for each maximal run of present elements. Full
+    // words are folded into a run without looking at individual bits.
+    template<typename F>
+    void
+    for_each_run(F&& f) const
+    {
+        size_t run_begin = 0;
+        size_t run_len   = 0;
+        for (size_t w = 0; w < m_validity.size(); ++w) {
+            uint64_t bits = m_validity[w];
+            size_t base   = w * word_bits;
+            if (bits == ~uint64_t{ 0 }) {
+                if (run_len == 0) {
+                    run_begin = base;
+                }
+                run_len += word_bits;
+                continue;
+            }
+            size_t pos = 0;
+            while (pos < word_bits) {
+                uint64_t rest = bits >> pos;
+                if (rest & 1) {
+                    uint64_t zeros = ~rest;
+                    size_t len     = zeros == 0 ? word_bits - pos : detail::ctz64(zeros);
+                    if (run_len == 0) {
+                        run_begin = base + pos;
+                    }
+                    run_len += len;
+                    pos += len;
+                }
+                else {
+                    if (run_len != 0) {
+                        f(run_begin, run_len);
+                        run_len = 0;
+                    }
+                    pos = rest == 0 ? word_bits : pos + detail::ctz64(rest);
+                }
+            }
+        }
+        if (run_len != 0) {
+            f(run_begin, run_len);
+        }
+    }
+
+    static size_t
+    words_for(size_t n)
+    {
+        return (n + word_bits - 1) / word_bits;
+    }
+
+    series<T> m_values;
+    std::vector<uint64_t> m_validity;
+};
+
+} // namespace mf
+
+
+#endif // INCLUDED_mainframe_nullable_series_h
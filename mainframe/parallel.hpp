@@ -0,0 +1,46 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_parallel_h
+#define INCLUDED_mainframe_parallel_h
+
+#include <algorithm>
+#include <thread>
+
+namespace mf
+{
+
+///
+/// parallel
+///
+/// Passed as the first argument to frame's sort(), sorted(), reverse_sort(),
+/// reverse_sorted() and argsort(), and to frame_view's sort() and sorted(),
+/// to spread the work over several threads. Each thread sorts a chunk of
+/// the rows, the sorted chunks are merged with every thread taking a share
+/// of each merge, and the columns are then gathered in parallel. The result
+/// is the same as sorting on one thread, down to the order of rows with
+/// equal keys.
+///
+///     f.sort(parallel{}, _2, _0);                 // a thread per core
+///     auto order = f.argsort(parallel{ 8 }, _0);  // at most 8 threads
+///
+/// Smaller frames use fewer threads, so asking for many is harmless.
+///
+struct parallel
+{
+    parallel()
+        : threads(std::max(1u, std::thread::hardware_concurrency()))
+    {}
+
+    explicit parallel(unsigned num_threads)
+        : threads(std::max(1u, num_threads))
+    {}
+
+    unsigned threads;
+};
+
+} // namespace mf
+
+
+#endif // INCLUDED_mainframe_parallel_h
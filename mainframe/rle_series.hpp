@@ -0,0 +1,310 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_rle_series_h
+#define INCLUDED_mainframe_rle_series_h
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mainframe/mask.hpp"
+#include "mainframe/series.hpp"
+
+namespace mf
+{
+
+///
+/// rle_series class
+///
+/// A run-length encoded column: each run of equal consecutive values is
+/// stored once, together with the position where the run ends. Dates,
+/// partition keys and other columns that repeat the same value for many
+/// rows shrink to the number of distinct runs, and mean(), minmax() and
+/// where() work run by run without expanding them.
+///
+///     rle_series<year_month_day> dates{ f.column(_0) };
+///     dates.num_runs();  // one per day, not one per row
+///     mask today = dates.where([&](auto& d) { return d == 2022_y / 1 / 3; });
+///     auto rows  = f.filter(today);
+///
+/// Elements are read-only once appended except through push_back(), which
+/// extends the last run when the value repeats. An rle_series isn't a
+/// frame column, so _row_proxy can't read it; as above, where() is how it
+/// selects the rows of a frame it runs alongside.
+///
+template<typename T>
+class rle_series
+{
+public:
+    using value_type = T;
+    using size_type  = size_t;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = T;
+        using pointer           = const T*;
+        using reference         = const T&;
+
+        const_iterator() = default;
+        const_iterator(const rle_series* s, size_t run, size_t pos)
+            : m_series(s)
+            , m_run(run)
+            , m_pos(pos)
+        {}
+
+        reference
+        operator*() const
+        {
+            return m_series->m_values[m_run];
+        }
+
+        pointer
+        operator->() const
+        {
+            return &**this;
+        }
+
+        const_iterator&
+        operator++()
+        {
+            if (++m_pos == m_series->m_ends[m_run]) {
+                ++m_run;
+            }
+            return *this;
+        }
+
+        const_iterator
+        operator++(int)
+        {
+            const_iterator out{ *this };
+            ++*this;
+            return out;
+        }
+
+        bool
+        operator==(const const_iterator& other) const
+        {
+            return m_pos == other.m_pos;
+        }
+
+        bool
+        operator!=(const const_iterator& other) const
+        {
+            return m_pos != other.m_pos;
+        }
+
+    private:
+        const rle_series* m_series = nullptr;
+        size_t m_run               = 0;
+        size_t m_pos               = 0;
+    };
+
+    rle_series() = default;
+
+    explicit rle_series(const series<T>& s)
+        : m_name(s.name())
+    {
+        for (const T& t : s) {
+            push_back(t);
+        }
+    }
+
+    rle_series(std::initializer_list<T> init)
+    {
+        for (const T& t : init) {
+            push_back(t);
+        }
+    }
+
+    const T&
+    at(size_t n) const
+    {
+        if (n >= size()) {
+            throw std::out_of_range{ "size() is " + std::to_string(size()) + ", pos is " +
+                std::to_string(n) };
+        }
+        return (*this)[n];
+    }
+
+    const_iterator
+    begin() const
+    {
+        return const_iterator{ this, 0, 0 };
+    }
+
+    const_iterator
+    end() const
+    {
+        return const_iterator{ this, m_values.size(), size() };
+    }
+
+    const_iterator
+    cbegin() const
+    {
+        return begin();
+    }
+
+    const_iterator
+    cend() const
+    {
+        return end();
+    }
+
+    void
+    clear()
+    {
+        m_values.clear();
+        m_ends.clear();
+    }
+
+    bool
+    empty() const
+    {
+        return m_ends.empty();
+    }
+
+    double
+    mean() const
+    {
+        double sum   = 0.0;
+        size_t begin = 0;
+        for (size_t r = 0; r < m_values.size(); ++r) {
+            sum += m_values[r] * static_cast<double>(m_ends[r] - begin);
+            begin = m_ends[r];
+        }
+        return sum / size();
+    }
+
+    /// Calculate the minimum and maximum value over the runs. Throws
+    /// std::out_of_range if the column is empty.
+    std::pair<T, T>
+    minmax() const
+    {
+        if (empty()) {
+            throw std::out_of_range{ "rle_series is empty" };
+        }
+        auto [mn, mx] = std::minmax_element(m_values.begin(), m_values.end());
+        return { *mn, *mx };
+    }
+
+    const std::string&
+    name() const
+    {
+        return m_name;
+    }
+
+    size_t
+    num_runs() const
+    {
+        return m_values.size();
+    }
+
+    const T&
+    operator[](size_t n) const
+    {
+        return m_values[run_index(n)];
+    }
+
+    bool
+    operator==(const rle_series& other) const
+    {
+        return m_name == other.m_name && m_values == other.m_values && m_ends == other.m_ends;
+    }
+
+    bool
+    operator!=(const rle_series& other) const
+    {
+        return !(*this == other);
+    }
+
+    void
+    push_back(const T& value)
+    {
+        if (!m_values.empty() && m_values.back() == value) {
+            ++m_ends.back();
+        }
+        else {
+            m_values.push_back(value);
+            m_ends.push_back(size() + 1);
+        }
+    }
+
+    /// The run containing element n
+    size_t
+    run_index(size_t n) const
+    {
+        return std::upper_bound(m_ends.begin(), m_ends.end(), n) - m_ends.begin();
+    }
+
+    size_t
+    run_length(size_t r) const
+    {
+        return m_ends.at(r) - (r == 0 ? 0 : m_ends[r - 1]);
+    }
+
+    const T&
+    run_value(size_t r) const
+    {
+        return m_values.at(r);
+    }
+
+    void
+    set_name(const std::string& name)
+    {
+        m_name = name;
+    }
+
+    size_t
+    size() const
+    {
+        return m_ends.empty() ? 0 : m_ends.back();
+    }
+
+    series<T>
+    to_series() const
+    {
+        series<T> out;
+        out.reserve(size());
+        size_t begin = 0;
+        for (size_t r = 0; r < m_values.size(); ++r) {
+            out.insert(out.cend(), m_ends[r] - begin, m_values[r]);
+            begin = m_ends[r];
+        }
+        out.set_name(m_name);
+        return out;
+    }
+
+    /// A mask with the bits set for elements where pred is true. pred is
+    /// called once per run, not once per element.
+    template<typename Pred>
+    mask
+    where(Pred pred) const
+    {
+        mask out;
+        out.reserve(size());
+        size_t begin = 0;
+        for (size_t r = 0; r < m_values.size(); ++r) {
+            out.append(m_ends[r] - begin, pred(m_values[r]));
+            begin = m_ends[r];
+        }
+        return out;
+    }
+
+private:
+    std::string m_name;
+    std::vector<T> m_values;
+    std::vector<size_t> m_ends;
+};
+
+} // namespace mf
+
+
+#endif // INCLUDED_mainframe_rle_series_h
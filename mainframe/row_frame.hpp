@@ -0,0 +1,649 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_row_frame_h
+#define INCLUDED_mainframe_row_frame_h
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "mainframe/expression.hpp"
+#include "mainframe/frame.hpp"
+#include "mainframe/memory_resource.hpp"
+#include "mainframe/series.hpp"
+
+namespace mf
+{
+
+namespace detail
+{
+
+// One row of a row_frame: the values of every column stored next to each
+// other, like the members of a struct. It is trivially copyable when all of
+// Ts are, so a row_frame of numbers is moved around with memcpy().
+template<typename T, typename... Ts>
+struct row_record
+{
+    row_record() = default;
+    row_record(const T& t, const Ts&... ts)
+        : head(t)
+        , tail(ts...)
+    {}
+
+    template<size_t Ind>
+    typename pack_element<Ind, T, Ts...>::type&
+    at()
+    {
+        if constexpr (Ind == 0) {
+            return head;
+        }
+        else {
+            return tail.template at<Ind - 1>();
+        }
+    }
+
+    template<size_t Ind>
+    const typename pack_element<Ind, T, Ts...>::type&
+    at() const
+    {
+        if constexpr (Ind == 0) {
+            return head;
+        }
+        else {
+            return tail.template at<Ind - 1>();
+        }
+    }
+
+    template<size_t Ind>
+    typename pack_element<Ind, T, Ts...>::type&
+    at(columnindex<Ind>)
+    {
+        return at<Ind>();
+    }
+
+    template<size_t Ind>
+    const typename pack_element<Ind, T, Ts...>::type&
+    at(columnindex<Ind>) const
+    {
+        return at<Ind>();
+    }
+
+    bool
+    operator==(const row_record& other) const
+    {
+        return head == other.head && tail == other.tail;
+    }
+
+    bool
+    operator!=(const row_record& other) const
+    {
+        return !(*this == other);
+    }
+
+    T head{};
+    row_record<Ts...> tail;
+};
+
+template<typename T>
+struct row_record<T>
+{
+    row_record() = default;
+    explicit row_record(const T& t)
+        : head(t)
+    {}
+
+    template<size_t Ind>
+    T&
+    at()
+    {
+        static_assert(Ind == 0, "column index out of range");
+        return head;
+    }
+
+    template<size_t Ind>
+    const T&
+    at() const
+    {
+        static_assert(Ind == 0, "column index out of range");
+        return head;
+    }
+
+    template<size_t Ind>
+    T&
+    at(columnindex<Ind>)
+    {
+        return at<Ind>();
+    }
+
+    template<size_t Ind>
+    const T&
+    at(columnindex<Ind>) const
+    {
+        return at<Ind>();
+    }
+
+    bool
+    operator==(const row_record& other) const
+    {
+        return head == other.head;
+    }
+
+    bool
+    operator!=(const row_record& other) const
+    {
+        return !(*this == other);
+    }
+
+    T head{};
+};
+
+} // namespace detail
+
+///
+/// An iterator over the rows of a @ref row_frame. It has the same shape as
+/// @ref base_frame_iterator, so expressions can be evaluated over it, but it
+/// is just a pointer to the current row.
+///
+template<bool IsConst, bool IsReverse, typename... Ts>
+class base_row_frame_iterator
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = detail::row_record<Ts...>;
+    using difference_type   = ptrdiff_t;
+    using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+    using pointer   = std::conditional_t<IsConst, const value_type*, value_type*>;
+
+    base_row_frame_iterator() = default;
+    explicit base_row_frame_iterator(pointer row)
+        : m_row(row)
+    {}
+
+    template<bool _IsConst = IsConst, std::enable_if_t<_IsConst, bool> = true>
+    base_row_frame_iterator(const base_row_frame_iterator<false, IsReverse, Ts...>& other)
+        : m_row(other.operator->())
+    {}
+
+    base_row_frame_iterator&
+    operator++()
+    {
+        return operator+=(1);
+    }
+    base_row_frame_iterator
+    operator++(int)
+    {
+        base_row_frame_iterator out{ *this };
+        operator+=(1);
+        return out;
+    }
+    base_row_frame_iterator&
+    operator--()
+    {
+        return operator-=(1);
+    }
+    base_row_frame_iterator
+    operator--(int)
+    {
+        base_row_frame_iterator out{ *this };
+        operator-=(1);
+        return out;
+    }
+
+    base_row_frame_iterator&
+    operator+=(ptrdiff_t n)
+    {
+        if constexpr (IsReverse) {
+            m_row -= n;
+        }
+        else {
+            m_row += n;
+        }
+        return *this;
+    }
+    base_row_frame_iterator&
+    operator-=(ptrdiff_t n)
+    {
+        return operator+=(-n);
+    }
+
+    reference
+    operator*() const
+    {
+        if constexpr (IsReverse) {
+            return *(m_row - 1);
+        }
+        else {
+            return *m_row;
+        }
+    }
+    pointer
+    operator->() const
+    {
+        return &operator*();
+    }
+    reference
+    operator[](ptrdiff_t n) const
+    {
+        return *(*this + n);
+    }
+
+    bool
+    operator==(const base_row_frame_iterator& other) const
+    {
+        return m_row == other.m_row;
+    }
+
+    bool
+    operator!=(const base_row_frame_iterator& other) const
+    {
+        return m_row != other.m_row;
+    }
+
+    bool
+    operator<(const base_row_frame_iterator& other) const
+    {
+        return (*this - other) < 0;
+    }
+
+    bool
+    operator>(const base_row_frame_iterator& other) const
+    {
+        return (*this - other) > 0;
+    }
+
+    bool
+    operator<=(const base_row_frame_iterator& other) const
+    {
+        return (*this - other) <= 0;
+    }
+
+    bool
+    operator>=(const base_row_frame_iterator& other) const
+    {
+        return (*this - other) >= 0;
+    }
+
+    ptrdiff_t
+    operator-(const base_row_frame_iterator& other) const
+    {
+        if constexpr (IsReverse) {
+            return other.m_row - m_row;
+        }
+        else {
+            return m_row - other.m_row;
+        }
+    }
+
+    base_row_frame_iterator
+    operator+(ptrdiff_t off) const
+    {
+        base_row_frame_iterator out{ *this };
+        out += off;
+        return out;
+    }
+
+    base_row_frame_iterator
+    operator-(ptrdiff_t off) const
+    {
+        base_row_frame_iterator out{ *this };
+        out -= off;
+        return out;
+    }
+
+private:
+    // For a reverse iterator, one past the row it refers to, like
+    // std::reverse_iterator
+    pointer m_row = nullptr;
+};
+
+///
+/// row-oriented dataframe class
+///
+/// row_frame holds the same kind of table as @ref frame, but stores it row
+/// by row: each row is a struct-like record of its column values, and the
+/// records sit back to back in one buffer. A frame needs one cache line per
+/// column to read or write a row; a row_frame needs one per row, which suits
+/// narrow tables that are appended to and read a whole row at a time.
+///
+///     row_frame<int64_t, double, int32_t> book;
+///     book.set_column_names("ts", "price", "qty");
+///     book.push_back(1667260800000, 101.25, 300);
+///     book.push_back(1667260800004, 101.50, 100);
+///     double p = book.row(1).at(_1);
+///
+/// It supports the row-wise part of the frame interface - iterators,
+/// row(), push_back(), sort() and rows() with the same expressions - and
+/// converts to and from a frame with one pass over the data, so a workload
+/// can build in one layout and analyse in the other:
+///
+///     frame<int64_t, double, int32_t> f = book.to_frame();
+///     double avg = f.mean(_1);
+///     row_frame<int64_t, double, int32_t> back(f);
+///
+/// Like frame, the rows are a reference-counted copy-on-write buffer, so
+/// copies are cheap until one of them is modified.
+///
+template<typename... Ts>
+class row_frame
+{
+public:
+    using iterator               = base_row_frame_iterator<false, false, Ts...>;
+    using const_iterator         = base_row_frame_iterator<true, false, Ts...>;
+    using reverse_iterator       = base_row_frame_iterator<false, true, Ts...>;
+    using const_reverse_iterator = base_row_frame_iterator<true, true, Ts...>;
+    using name_array             = std::array<std::string, sizeof...(Ts)>;
+    using row_type               = detail::row_record<Ts...>;
+
+    row_frame() = default;
+
+    /// Create an empty row_frame whose rows allocate from resource rather
+    /// than the default memory resource
+    explicit row_frame(memory_resource* resource)
+        : m_rows(resource)
+    {}
+
+    /// Copy a column-oriented frame into rows
+    explicit row_frame(const frame<Ts...>& f)
+        : m_names(f.column_names())
+    {
+        from_frame_impl(f, std::index_sequence_for<Ts...>{});
+    }
+
+    iterator
+    begin()
+    {
+        return iterator{ m_rows.data() };
+    }
+
+    iterator
+    end()
+    {
+        return iterator{ m_rows.data() + m_rows.size() };
+    }
+
+    const_iterator
+    begin() const
+    {
+        return cbegin();
+    }
+
+    const_iterator
+    end() const
+    {
+        return cend();
+    }
+
+    const_iterator
+    cbegin() const
+    {
+        return const_iterator{ m_rows.data() };
+    }
+
+    const_iterator
+    cend() const
+    {
+        return const_iterator{ m_rows.data() + m_rows.size() };
+    }
+
+    reverse_iterator
+    rbegin()
+    {
+        return reverse_iterator{ m_rows.data() + m_rows.size() };
+    }
+
+    reverse_iterator
+    rend()
+    {
+        return reverse_iterator{ m_rows.data() };
+    }
+
+    const_reverse_iterator
+    crbegin() const
+    {
+        return const_reverse_iterator{ m_rows.data() + m_rows.size() };
+    }
+
+    const_reverse_iterator
+    crend() const
+    {
+        return const_reverse_iterator{ m_rows.data() };
+    }
+
+    void
+    clear()
+    {
+        m_rows.clear();
+    }
+
+    template<size_t Ind>
+    std::string
+    column_name() const
+    {
+        return m_names[Ind];
+    }
+
+    template<size_t Ind>
+    std::string
+    column_name(columnindex<Ind>) const
+    {
+        return m_names[Ind];
+    }
+
+    name_array
+    column_names() const
+    {
+        return m_names;
+    }
+
+    bool
+    empty() const
+    {
+        return m_rows.empty();
+    }
+
+    memory_stats
+    memory_usage() const
+    {
+        return m_rows.memory_usage();
+    }
+
+    size_t
+    num_columns() const
+    {
+        return sizeof...(Ts);
+    }
+
+    void
+    pop_back()
+    {
+        m_rows.pop_back();
+    }
+
+    void
+    push_back(const Ts&... ts)
+    {
+        m_rows.push_back(row_type{ ts... });
+    }
+
+    void
+    push_back(const row_type& r)
+    {
+        m_rows.push_back(r);
+    }
+
+    void
+    reserve(size_t newsize)
+    {
+        m_rows.reserve(newsize);
+    }
+
+    void
+    resize(size_t newsize)
+    {
+        m_rows.resize(newsize);
+    }
+
+    template<size_t... Inds>
+    void
+    reverse_sort(columnindex<Inds>...)
+    {
+        detail::build_gt<row_type, Inds...> op;
+        std::sort(begin(), end(), op);
+    }
+
+    row_type&
+    row(size_t ind)
+    {
+        return m_rows[ind];
+    }
+
+    const row_type&
+    row(size_t ind) const
+    {
+        return m_rows[ind];
+    }
+
+    /// The rows for which ex is true, evaluated exactly as frame::rows()
+    /// does
+    ///
+    ///     auto big = book.rows(_2 >= 100 && _1 > _1[-1]);
+    ///
+    template<typename Ex>
+    std::enable_if_t<is_expression<Ex>::value, row_frame<Ts...>>
+    rows(Ex ex) const
+    {
+        row_frame<Ts...> out;
+        out.m_names = m_names;
+
+        auto b    = cbegin();
+        auto curr = b;
+        auto e    = cend();
+        for (; curr != e; ++curr) {
+            if (ex(b, curr, e)) {
+                out.m_rows.push_back(*curr);
+            }
+        }
+        return out;
+    }
+
+    void
+    set_column_names(const name_array& names)
+    {
+        m_names = names;
+    }
+
+    void
+    set_column_names(const std::vector<std::string>& names)
+    {
+        for (size_t i = 0; i < names.size() && i < sizeof...(Ts); ++i) {
+            m_names[i] = names[i];
+        }
+    }
+
+    template<typename... Us>
+    void
+    set_column_names(const Us&... colnames)
+    {
+        static_assert(sizeof...(Us) == sizeof...(Ts), "wrong number of column names");
+        m_names = name_array{ std::string{ colnames }... };
+    }
+
+    void
+    shrink_to_fit()
+    {
+        m_rows.shrink_to_fit();
+    }
+
+    size_t
+    size() const
+    {
+        return m_rows.size();
+    }
+
+    template<size_t... Inds>
+    void
+    sort(columnindex<Inds>...)
+    {
+        detail::build_lt<row_type, Inds...> op;
+        std::sort(begin(), end(), op);
+    }
+
+    template<size_t... Inds>
+    row_frame<Ts...>
+    sorted(columnindex<Inds>... ci) const
+    {
+        row_frame<Ts...> out{ *this };
+        out.sort(ci...);
+        return out;
+    }
+
+    /// Copy the rows into a column-oriented frame. Each column is filled
+    /// in its own pass, so every pass writes one array sequentially.
+    frame<Ts...>
+    to_frame() const
+    {
+        frame<Ts...> out;
+        out.set_column_names(m_names);
+        out.resize(size());
+        to_frame_impl(out, std::index_sequence_for<Ts...>{});
+        return out;
+    }
+
+    bool
+    operator==(const row_frame& other) const
+    {
+        return std::equal(cbegin(), cend(), other.cbegin(), other.cend());
+    }
+
+    bool
+    operator!=(const row_frame& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    template<size_t... Inds>
+    void
+    from_frame_impl(const frame<Ts...>& f, std::index_sequence<Inds...>)
+    {
+        size_t num_rows = f.size();
+        m_rows.resize(num_rows);
+        row_type* dest = m_rows.data();
+        std::tuple<const Ts*...> cols{ f.column(columnindex<Inds>{}).data()... };
+        for (size_t i = 0; i < num_rows; ++i) {
+            ((dest[i].template at<Inds>() = std::get<Inds>(cols)[i]), ...);
+        }
+    }
+
+    template<size_t... Inds>
+    void
+    to_frame_impl(frame<Ts...>& out, std::index_sequence<Inds...>) const
+    {
+        (to_frame_column<Inds>(out), ...);
+    }
+
+    template<size_t Ind>
+    void
+    to_frame_column(frame<Ts...>& out) const
+    {
+        auto* dest          = out.column(columnindex<Ind>{}).data();
+        const row_type* src = m_rows.data();
+        for (size_t i = 0; i < m_rows.size(); ++i) {
+            dest[i] = src[i].template at<Ind>();
+        }
+    }
+
+    series<row_type> m_rows;
+    name_array m_names;
+};
+
+} // namespace mf
+
+
+#endif // INCLUDED_mainframe_row_frame_h
@@ -22,8 +22,10 @@
 #include <vector>
 
 #include "mainframe/detail/base.hpp"
+#include "mainframe/detail/radix_sort.hpp"
 #include "mainframe/detail/series_vector.hpp"
 #include "mainframe/detail/useries.hpp"
+#include "mainframe/memory_resource.hpp"
 #include "mainframe/missing.hpp"
 
 namespace mf
@@ -71,6 +73,9 @@ public:
     // ctors
     series();
 
+    /// Create an empty series whose buffer is allocated from resource
+    explicit series(memory_resource* resource);
+
     series(size_t count, const T& value);
 
     explicit series(size_t count);
@@ -80,10 +85,28 @@ public:
 
     series(const series& other) = default;
 
-    series(series&& other);
+    series(series&& other) noexcept;
 
     explicit series(std::initializer_list<T> init);
 
+    /// A read-only view of [first, last) in a buffer that owner keeps
+    /// alive, such as a memory-mapped file. Nothing is copied until the
+    /// series is written to, when the elements are copied into a buffer of
+    /// its own and owner is released.
+    series(std::shared_ptr<const void> owner, const T* first, const T* last);
+
+    /// Take over count elements at first, e.g. an array filled by a feed
+    /// handler or numeric library, without copying them. deleter(first) is
+    /// called once no series refers to the elements any more. As with the
+    /// constructor above, the buffer is never written to; the series copies
+    /// it into storage of its own when first modified.
+    ///
+    ///     double* prices = feed.take_batch(&n);
+    ///     series<double> s(prices, n, [](double* p) { std::free(p); });
+    ///
+    template<typename Deleter>
+    series(T* first, size_t count, Deleter deleter);
+
     virtual ~series() = default;
 
     // begin, cbegin, end, cend
@@ -207,6 +230,9 @@ public:
     const_reference
     front() const;
 
+    memory_resource*
+    get_memory_resource() const;
+
     // insert & emplace
     iterator
     insert(const_iterator pos, const T& value);
@@ -230,6 +256,16 @@ public:
     double
     mean() const;
 
+    /// The bytes this series uses; see @ref memory_stats
+    ///
+    ///     series<double> s;
+    ///     for (int i = 0; i < 1000; ++i) { s.push_back(i); }
+    ///     s.memory_usage().logical_bytes;  // 8000
+    ///     s.memory_usage().capacity_bytes; // 8192
+    ///
+    memory_stats
+    memory_usage() const;
+
     /// Calculate the minimum and maximum value in the series, and return them in
     /// a std::pair<>
     ///
@@ -244,7 +280,7 @@ public:
 
     // operator=
     series&
-    operator=(series&& other);
+    operator=(series&& other) noexcept;
 
     series&
     operator=(const series&) = default;
@@ -367,15 +403,48 @@ public:
     void
     resize(size_t newsize, const T& value);
 
+    /// Sort the elements in descending order. See sort().
+    void
+    reverse_sort();
+
+    series
+    reverse_sorted() const;
+
     void
     set_name(const std::string& name);
 
+    /// Reduce capacity() to size(), handing the slack back to the memory
+    /// resource. A slice is copied into a buffer of its own so that it no
+    /// longer keeps the whole parent buffer alive. A buffer that is shared
+    /// with other series is left alone, since compacting it would mean
+    /// copying it.
     void
     shrink_to_fit();
 
     size_t
     size() const;
 
+    /// A view of elements [begin, end) that shares this series' buffer
+    /// rather than copying it. The view is read-only until it is written
+    /// to, at which point it copies just its own elements, and it stays
+    /// valid if this series is later modified or destroyed.
+    ///
+    ///     series<double> s{ 1.0, 2.0, 3.0, 4.0 };
+    ///     series<double> window = s.slice(1, 3); // 2.0, 3.0 - no copy
+    ///
+    series
+    slice(size_t begin, size_t end) const;
+
+    /// Sort the elements in ascending order. Integers, floating point
+    /// values, std::chrono durations and time points, and calendar dates
+    /// like year_month_day are radix sorted on an order-preserving
+    /// encoding of their bits; anything else is sorted by operator<.
+    void
+    sort();
+
+    series
+    sorted() const;
+
     double
     stddev() const;
 
@@ -392,6 +461,9 @@ public:
     unref();
 
 private:
+    const series_vector<T>&
+    cvec() const;
+
     iterator
     unref(iterator it);
 
@@ -405,6 +477,11 @@ private:
 
     std::string m_name;
     std::shared_ptr<series_vector<T>> m_sharedvec;
+    // What the buffer is allocated from while m_sharedvec is null. It is
+    // captured when the series is created, so that one created outside an
+    // arena_scope and first written to inside it doesn't allocate from the
+    // arena.
+    memory_resource* m_resource = get_default_resource();
 };
 
 } // namespace mf
@@ -0,0 +1,210 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_sort_keys_h
+#define INCLUDED_mainframe_sort_keys_h
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "mainframe/detail/parallel.hpp"
+#include "mainframe/detail/sort_key.hpp"
+#include "mainframe/parallel.hpp"
+#include "mainframe/series.hpp"
+
+namespace mf
+{
+
+///
+/// sort_keys class
+///
+/// Some key columns normalized into one fixed-width byte string per row,
+/// such that comparing two rows' keys with memcmp() orders them as sort()
+/// would. Each column is encoded so that its bytes compare in the order of
+/// its operator<:
+///
+/// - integers have their sign bit flipped, and are stored big-endian
+/// - floating point values have their sign bit flipped, and every other
+///   bit too if they're negative
+/// - std::chrono durations and time points, and calendar dates like
+///   year_month_day, are encoded like the integers behind them
+/// - mi<T> and smi<T> start with a byte that is 0 for missing, so missing
+///   sorts first
+/// - strings keep their first 15 bytes and their length; two longer
+///   strings with the same prefix are told apart by comparing the strings
+///
+/// frame::sort() and its relatives build keys like these on their own
+/// whenever the key columns don't fit a radix sort. Building them
+/// explicitly lets the same keys be reused: to sort, to merge-join against
+/// keys of another frame, and to look rows up in sorted order.
+///
+///     auto keys  = trades.make_sort_keys(_2, _0);   // venue, id
+///     auto order = keys.argsort();
+///     auto first = keys.lower_bound(order, "XLON", 1000);
+///     auto last  = keys.upper_bound(order, "XLON", 2000);
+///     // order[first] ... order[last - 1] are the XLON trades with ids in
+///     // [1000, 2000], by id
+///
+/// Keys keep a reference to their columns' buffers, which the string
+/// tie-break reads, so they stay valid if the frame changes.
+///
+template<typename... Ts>
+class sort_keys
+{
+    using layout     = detail::key_layout<Ts...>;
+    using column_ptr = std::tuple<const Ts*...>;
+
+public:
+    static_assert(detail::key_sortable<Ts...>::value,
+        "sort_keys supports arithmetic, std::chrono, calendar date, string, mi and smi columns");
+
+    /// The length of each row's key in bytes
+    static constexpr size_t width = layout::width;
+
+    sort_keys() = default;
+
+    /// Throws std::invalid_argument if the columns have different lengths
+    explicit sort_keys(const series<Ts>&... cols)
+        : m_columns(cols...)
+    {
+        size_t sizes[] = { cols.size()... };
+        for (size_t s : sizes) {
+            if (s != sizes[0]) {
+                throw std::invalid_argument{ "sort_keys columns have different lengths" };
+            }
+        }
+        m_size          = sizes[0];
+        column_ptr cptr = columns();
+        m_keys.resize(m_size * width);
+        for (size_t r = 0; r < m_size; ++r) {
+            layout::encode(cptr, r, m_keys.data() + r * width);
+        }
+    }
+
+    /// The order that sorts the rows, as frame::argsort() gives it
+    std::vector<size_t>
+    argsort() const
+    {
+        return argsort(parallel{ 1 });
+    }
+
+    std::vector<size_t>
+    argsort(parallel p) const
+    {
+        std::vector<size_t> order(m_size);
+        std::iota(order.begin(), order.end(), size_t{ 0 });
+        detail::sort_on_keys<false>(order, detail::useful_threads(p.threads, m_size), columns(),
+            [&](size_t row, uint8_t* out) { std::memcpy(out, key(row), width); });
+        return order;
+    }
+
+    /// Three-way comparison of rows l and r: negative if l sorts first,
+    /// positive if r does and zero if their keys are equal
+    int
+    compare(size_t l, size_t r) const
+    {
+        return compare(l, *this, r);
+    }
+
+    /// Three-way comparison of row l with row r of other, e.g. to walk two
+    /// sorted frames in step for a merge join
+    int
+    compare(size_t l, const sort_keys& other, size_t r) const
+    {
+        return layout::compare(key(l), other.key(r), [&] {
+            return detail::compare_values(columns(), l, other.columns(), r);
+        });
+    }
+
+    const uint8_t*
+    data() const
+    {
+        return m_keys.data();
+    }
+
+    bool
+    empty() const
+    {
+        return m_size == 0;
+    }
+
+    /// The key of a row: width bytes
+    const uint8_t*
+    key(size_t row) const
+    {
+        return m_keys.data() + row * width;
+    }
+
+    /// The first position in order, which must sort the rows as argsort()
+    /// does, whose row doesn't sort before the given values
+    size_t
+    lower_bound(const std::vector<size_t>& order, const Ts&... values) const
+    {
+        return bound(order, [](int c) { return c < 0; }, values...);
+    }
+
+    size_t
+    size() const
+    {
+        return m_size;
+    }
+
+    /// The first position in order, which must sort the rows as argsort()
+    /// does, whose row sorts after the given values
+    size_t
+    upper_bound(const std::vector<size_t>& order, const Ts&... values) const
+    {
+        return bound(order, [](int c) { return c <= 0; }, values...);
+    }
+
+private:
+    // Binary search for the first position whose row's comparison with the
+    // values doesn't satisfy before(c)
+    template<typename Before>
+    size_t
+    bound(const std::vector<size_t>& order, Before before, const Ts&... values) const
+    {
+        std::array<uint8_t, width> probe;
+        column_ptr pcols = std::make_tuple(&values...);
+        layout::encode(pcols, 0, probe.data());
+
+        size_t lo = 0;
+        size_t hi = order.size();
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            size_t row = order[mid];
+            int c      = layout::compare(key(row), probe.data(), [&] {
+                return detail::compare_values(columns(), row, pcols, 0);
+            });
+            if (before(c)) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    column_ptr
+    columns() const
+    {
+        return std::apply([](const auto&... s) { return std::make_tuple(s.data()...); }, m_columns);
+    }
+
+    std::tuple<series<Ts>...> m_columns;
+    std::vector<uint8_t> m_keys;
+    size_t m_size = 0;
+};
+
+} // namespace mf
+
+
+#endif // INCLUDED_mainframe_sort_keys_h
@@ -0,0 +1,427 @@
+//          Copyright Santiago Urrego Botero 2022.
+
+
+
+#ifndef INCLUDED_mainframe_string_series_h
+#define INCLUDED_mainframe_string_series_h
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mainframe/mask.hpp"
+#include "mainframe/series.hpp"
+
+namespace mf
+{
+
+///
+/// string_series class
+///
+/// A column of strings stored as one contiguous byte arena plus an array of
+/// offsets into it, instead of one std::string (and, for long values, one
+/// heap allocation) per element. Elements are read as std::string_view.
+/// The arena, offsets and prefixes are themselves series, so copies share
+/// them and the first write after a copy detaches each with a single
+/// memcpy rather than copying every string.
+///
+///     string_series names{ "carol", "alice", "bob" };
+///     std::string_view n = names[1];  // "alice", points into the arena
+///     string_series sorted = names.sort(); // alice, bob, carol
+///
+/// Each element also keeps its first 8 bytes as a big-endian integer, so
+/// most comparisons in sort() and argsort() are a single integer compare.
+///
+/// A string_series isn't a frame column, so _row_proxy can't read it, but
+/// it can sort and select the rows of a frame it runs alongside:
+///
+///     auto by_name = f.gather(names.argsort());
+///     auto as      = f.filter(names.where([](auto n) { return n[0] == 'a'; }));
+///
+class string_series
+{
+public:
+    using value_type = std::string_view;
+    using size_type  = size_t;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using difference_type   = std::ptrdiff_t;
+        using value_type        = std::string_view;
+        using pointer           = const std::string_view*;
+        using reference         = std::string_view;
+
+        const_iterator() = default;
+        const_iterator(const string_series* s, size_t pos)
+            : m_series(s)
+            , m_pos(pos)
+        {}
+
+        std::string_view
+        operator*() const
+        {
+            return (*m_series)[m_pos];
+        }
+
+        std::string_view
+        operator[](difference_type n) const
+        {
+            return (*m_series)[m_pos + n];
+        }
+
+        const_iterator&
+        operator++()
+        {
+            ++m_pos;
+            return *this;
+        }
+
+        const_iterator
+        operator++(int)
+        {
+            const_iterator out{ *this };
+            ++m_pos;
+            return out;
+        }
+
+        const_iterator&
+        operator--()
+        {
+            --m_pos;
+            return *this;
+        }
+
+        const_iterator
+        operator--(int)
+        {
+            const_iterator out{ *this };
+            --m_pos;
+            return out;
+        }
+
+        const_iterator&
+        operator+=(difference_type n)
+        {
+            m_pos += n;
+            return *this;
+        }
+
+        const_iterator&
+        operator-=(difference_type n)
+        {
+            m_pos -= n;
+            return *this;
+        }
+
+        const_iterator
+        operator+(difference_type n) const
+        {
+            return const_iterator{ m_series, m_pos + n };
+        }
+
+        const_iterator
+        operator-(difference_type n) const
+        {
+            return const_iterator{ m_series, m_pos - n };
+        }
+
+        difference_type
+        operator-(const const_iterator& other) const
+        {
+            return static_cast<difference_type>(m_pos) - static_cast<difference_type>(other.m_pos);
+        }
+
+        bool
+        operator==(const const_iterator& other) const
+        {
+            return m_pos == other.m_pos;
+        }
+
+        bool
+        operator!=(const const_iterator& other) const
+        {
+            return m_pos != other.m_pos;
+        }
+
+        bool
+        operator<(const const_iterator& other) const
+        {
+            return m_pos < other.m_pos;
+        }
+
+    private:
+        const string_series* m_series = nullptr;
+        size_t m_pos                  = 0;
+    };
+
+    string_series() = default;
+
+    string_series(std::initializer_list<std::string_view> init)
+    {
+        for (std::string_view s : init) {
+            push_back(s);
+        }
+    }
+
+    explicit string_series(const series<std::string>& s)
+    {
+        size_t bytes = 0;
+        for (const std::string& e : s) {
+            bytes += e.size();
+        }
+        reserve(s.size(), bytes);
+        for (const std::string& e : s) {
+            push_back(e);
+        }
+        set_name(s.name());
+    }
+
+    /// The indices that would sort this column. Ties keep their original
+    /// order.
+    std::vector<size_t>
+    argsort() const
+    {
+        std::vector<size_t> out(size());
+        std::iota(out.begin(), out.end(), size_t{ 0 });
+        const uint64_t* prefixes = m_prefixes.data();
+        std::stable_sort(out.begin(), out.end(), [&](size_t l, size_t r) {
+            if (prefixes[l] != prefixes[r]) {
+                return prefixes[l] < prefixes[r];
+            }
+            return (*this)[l] < (*this)[r];
+        });
+        return out;
+    }
+
+    std::string_view
+    at(size_t n) const
+    {
+        if (n >= size()) {
+            throw std::out_of_range{ "size() is " + std::to_string(size()) + ", pos is " +
+                std::to_string(n) };
+        }
+        return (*this)[n];
+    }
+
+    const_iterator
+    begin() const
+    {
+        return const_iterator{ this, 0 };
+    }
+
+    const_iterator
+    end() const
+    {
+        return const_iterator{ this, size() };
+    }
+
+    const_iterator
+    cbegin() const
+    {
+        return begin();
+    }
+
+    const_iterator
+    cend() const
+    {
+        return end();
+    }
+
+    /// Total length of all the strings
+    size_t
+    bytes() const
+    {
+        return m_bytes.size();
+    }
+
+    void
+    clear()
+    {
+        m_bytes.clear();
+        m_offsets.clear();
+        m_prefixes.clear();
+    }
+
+    bool
+    empty() const
+    {
+        return m_prefixes.empty();
+    }
+
+    /// The elements at positions inds, in that order
+    string_series
+    gather(const std::vector<size_t>& inds) const
+    {
+        size_t nbytes = 0;
+        for (size_t i : inds) {
+            nbytes += length(i);
+        }
+        string_series out;
+        out.reserve(inds.size(), nbytes);
+        for (size_t i : inds) {
+            out.push_back((*this)[i]);
+        }
+        out.set_name(name());
+        return out;
+    }
+
+    const std::string&
+    name() const
+    {
+        return m_bytes.name();
+    }
+
+    std::string_view
+    operator[](size_t n) const
+    {
+        const uint64_t* offs = m_offsets.data();
+        return std::string_view{ m_bytes.data() + offs[n], offs[n + 1] - offs[n] };
+    }
+
+    bool
+    operator==(const string_series& other) const
+    {
+        return name() == other.name() && size() == other.size() && m_offsets == other.m_offsets &&
+            std::equal(m_bytes.cbegin(), m_bytes.cend(), other.m_bytes.cbegin());
+    }
+
+    bool
+    operator!=(const string_series& other) const
+    {
+        return !(*this == other);
+    }
+
+    void
+    pop_back()
+    {
+        m_bytes.resize(m_offsets[size() - 1]);
+        m_offsets.pop_back();
+        m_prefixes.pop_back();
+        if (m_prefixes.empty()) {
+            m_offsets.clear();
+        }
+    }
+
+    void
+    push_back(std::string_view s)
+    {
+        if (m_offsets.empty()) {
+            m_offsets.push_back(0);
+        }
+        m_bytes.insert(m_bytes.cend(), s.begin(), s.end());
+        m_offsets.push_back(m_bytes.size());
+        m_prefixes.push_back(prefix_of(s));
+    }
+
+    /// Reserve room for count strings totalling bytes characters
+    void
+    reserve(size_t count, size_t bytes)
+    {
+        m_bytes.reserve(bytes);
+        m_offsets.reserve(count + 1);
+        m_prefixes.reserve(count);
+    }
+
+    void
+    set_name(const std::string& name)
+    {
+        m_bytes.set_name(name);
+    }
+
+    size_t
+    size() const
+    {
+        return m_prefixes.size();
+    }
+
+    /// A sorted copy of this column
+    string_series
+    sort() const
+    {
+        return gather(argsort());
+    }
+
+    /// Copy into a series<std::string>
+    series<std::string>
+    to_series() const
+    {
+        series<std::string> out;
+        out.reserve(size());
+        for (std::string_view s : *this) {
+            out.push_back(std::string{ s });
+        }
+        out.set_name(name());
+        return out;
+    }
+
+    std::vector<std::string>
+    to_string() const
+    {
+        std::vector<std::string> out;
+        out.reserve(size());
+        for (std::string_view s : *this) {
+            out.emplace_back(s);
+        }
+        return out;
+    }
+
+    /// A mask with the bits set for elements where pred(std::string_view)
+    /// is true, e.g. to pass to frame::filter()
+    template<typename Pred>
+    mask
+    where(Pred pred) const
+    {
+        mask out;
+        out.reserve(size());
+        for (std::string_view s : *this) {
+            out.push_back(pred(s));
+        }
+        return out;
+    }
+
+    /// How many string_series share this one's arena
+    size_t
+    use_count() const
+    {
+        return m_bytes.use_count();
+    }
+
+private:
+    size_t
+    length(size_t n) const
+    {
+        const uint64_t* offs = m_offsets.data();
+        return offs[n + 1] - offs[n];
+    }
+
+    // The first 8 bytes, zero-padded, as a big-endian integer so that
+    // comparing prefixes orders them like the strings they come from
+    static uint64_t
+    prefix_of(std::string_view s)
+    {
+        uint64_t out = 0;
+        size_t n     = std::min<size_t>(s.size(), sizeof(out));
+        for (size_t i = 0; i < n; ++i) {
+            out |= uint64_t{ static_cast<unsigned char>(s[i]) } << (8 * (7 - i));
+        }
+        return out;
+    }
+
+    series<char> m_bytes;
+    series<uint64_t> m_offsets;
+    series<uint64_t> m_prefixes;
+};
+
+} // namespace mf
+
+
+#endif // INCLUDED_mainframe_string_series_h
@@ -8418,7 +8418,7 @@ namespace Catch {
 // start clara.hpp
 // Copyright 2017 Two Blue Cubes Ltd. All rights reserved.
 //
- (See accompanying
+//    (See accompanying
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
 // See https://github.com/philsquared/Clara for more details
@@ -8449,7 +8449,7 @@ namespace Catch {
 //
 // A single-header library for wrapping and laying out basic text, by Phil Nash
 //
- (See accompanying
+//    (See accompanying
 // file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
 // This project is hosted at https://github.com/philsquared/textflowcpp
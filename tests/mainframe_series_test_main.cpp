@@ -186,6 +186,34 @@ TEST_CASE("ctor( && )", "[series]")
     REQUIRE(s2.use_count() == 1);
 }
 
+TEST_CASE("empty series don't allocate", "[series]")
+{
+    series<double> s1;
+    series<double> s2(s1);
+    series<double> s3(std::move(s2));
+    REQUIRE(s1.empty());
+    REQUIRE(s3.size() == 0);
+    REQUIRE(s1.capacity() == 0);
+    REQUIRE(s1.data() == nullptr);
+    REQUIRE(s1.begin() == s1.end());
+    REQUIRE(s1.use_count() == 1);
+    REQUIRE(s1 == s3);
+    REQUIRE(std::is_nothrow_move_constructible_v<series<double>>);
+    REQUIRE(std::is_nothrow_move_assignable_v<series<double>>);
+
+    s1.push_back(1.0);
+    REQUIRE(s1.size() == 1);
+    REQUIRE(s3.size() == 0);
+    s3 = s1;
+    REQUIRE(s3.use_count() == 2);
+    s1.clear();
+    REQUIRE(s1.empty());
+    REQUIRE(s3.size() == 1);
+    s1.insert(s1.cbegin(), 2.0);
+    REQUIRE(s1.size() == 1);
+    REQUIRE(s1[0] == 2.0);
+}
+
 TEST_CASE("ctor( initializer_list )", "[series]")
 {
     foo f0{ "f0" };
@@ -1974,3 +2002,576 @@ TEST_CASE("arithmetic", "[series]")
 }
 
 
+
+TEST_CASE("chunked_series", "[series]")
+{
+    chunked_series<int> c1(4);
+    for (int i = 0; i < 10; ++i) {
+        c1.push_back(i);
+    }
+    REQUIRE(c1.size() == 10);
+    REQUIRE(c1.num_chunks() == 3);
+    REQUIRE(c1.chunk_length(2) == 2);
+    const int* chunk0 = c1.chunk_data(0);
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(c1[i] == i);
+    }
+    REQUIRE_THROWS_AS(c1.at(10), std::out_of_range);
+
+    // appending never moves existing chunks
+    c1.push_back(10);
+    REQUIRE(c1.chunk_data(0) == chunk0);
+
+    // writing to a shared column only copies the chunk written to
+    chunked_series<int> c2 = c1;
+    REQUIRE(c2.chunk_use_count(0) == 2);
+    c2.at(5) = 50;
+    REQUIRE(c1[5] == 5);
+    REQUIRE(c2[5] == 50);
+    REQUIRE(c2.chunk_data(0) == chunk0);
+    REQUIRE(c1.chunk_data(1) != c2.chunk_data(1));
+    REQUIRE(c2.chunk_use_count(0) == 2);
+    REQUIRE(c2.chunk_use_count(1) == 1);
+    REQUIRE(c2.chunk_use_count(2) == 2);
+
+    // concatenation splices chunks, including a partially full one
+    chunked_series<int> c3 = c1 + c2;
+    REQUIRE(c3.size() == 22);
+    REQUIRE(c3.num_chunks() == 6);
+    REQUIRE(c3.chunk_data(0) == chunk0);
+    REQUIRE(c3[10] == 10);
+    REQUIRE(c3[11] == 0);
+    REQUIRE(c3[16] == 50);
+    REQUIRE(c3[21] == 10);
+    c3.push_back(11);
+    REQUIRE(c3.size() == 23);
+    REQUIRE(c3[22] == 11);
+    REQUIRE(c2.size() == 11);
+
+    series<int> s1 = c3.to_series();
+    REQUIRE(s1.size() == 23);
+    REQUIRE(std::equal(s1.cbegin(), s1.cend(), c3.begin()));
+
+    chunked_series<int> c4(s1, 8);
+    REQUIRE(c4.num_chunks() == 3);
+    REQUIRE(c4 == c3);
+    REQUIRE(c4.mean() == Approx(s1.mean()));
+
+    // appending a column to itself
+    chunked_series<int> c5(4);
+    for (int i = 0; i < 6; ++i) {
+        c5.push_back(i);
+    }
+    c5.append(c5);
+    REQUIRE(c5.size() == 12);
+    REQUIRE(c5.num_chunks() == 4);
+    for (int i = 0; i < 12; ++i) {
+        REQUIRE(c5[i] == i % 6);
+    }
+    c5.at(0) = 100;
+    REQUIRE(c5[6] == 0);
+    c5.push_back(6);
+    REQUIRE(c5.size() == 13);
+    REQUIRE(c5[12] == 6);
+    REQUIRE(c5[5] == 5);
+}
+
+TEST_CASE("slice()", "[series]")
+{
+    series<double> s1{ 1.0, 2.0, 3.0, 4.0, 5.0 };
+    s1.set_name("price");
+    series<double> s2 = s1.slice(1, 4);
+    const series<double>& cs1 = s1;
+    const series<double>& cs2 = s2;
+    REQUIRE(cs2.size() == 3);
+    REQUIRE(cs2.name() == "price");
+    REQUIRE(cs2[0] == 2.0);
+    REQUIRE(cs2[2] == 4.0);
+    REQUIRE(cs2.mean() == 3.0);
+
+    // shares the parent's buffer until written to
+    REQUIRE(cs2.data() == cs1.data() + 1);
+
+    // writing to the slice copies only the slice
+    s2[0] = 20.0;
+    REQUIRE(s2[0] == 20.0);
+    REQUIRE(s1[1] == 2.0);
+    REQUIRE(cs2.data() != cs1.data() + 1);
+
+    // writing to the parent leaves existing slices alone
+    series<double> s3 = s1.slice(0, 2);
+    s1[0]             = 10.0;
+    REQUIRE(s3[0] == 1.0);
+    REQUIRE(s1[0] == 10.0);
+
+    // slices outlive their parent
+    series<int> s4;
+    {
+        series<int> s5{ 1, 2, 3 };
+        s4 = s5.slice(1, 3);
+    }
+    REQUIRE(s4.size() == 2);
+    REQUIRE(s4[1] == 3);
+    s4.push_back(4);
+    REQUIRE(s4.size() == 3);
+    REQUIRE(s4[2] == 4);
+
+    REQUIRE(s1.slice(2, 2).empty());
+    REQUIRE_THROWS_AS(s1.slice(3, 2), std::out_of_range);
+    REQUIRE_THROWS_AS(s1.slice(0, 6), std::out_of_range);
+}
+
+TEST_CASE("sort()/sorted()", "[series]")
+{
+    series<int> s1{ 3, -1, 2, -7, 0 };
+    REQUIRE(s1.sorted() == series<int>{ -7, -1, 0, 2, 3 });
+    REQUIRE(s1.reverse_sorted() == series<int>{ 3, 2, 0, -1, -7 });
+    REQUIRE(s1[0] == 3);
+
+    // large enough to be radix sorted
+    series<double> s2;
+    series<int64_t> s3;
+    series<sys_seconds> s4;
+    series<year_month_day> s5;
+    for (int i = 0; i < 3000; ++i) {
+        int64_t v = (static_cast<int64_t>(i) * 7919) % 2003 - 1000;
+        s2.push_back(static_cast<double>(v) / 8.0);
+        s3.push_back(v * 1000000007LL);
+        s4.push_back(sys_seconds{ seconds{ v * 86400 } });
+        s5.push_back(year_month_day{ sys_days{ days{ v } } });
+    }
+    s2.push_back(-std::numeric_limits<double>::infinity());
+    s2.push_back(std::numeric_limits<double>::infinity());
+    s2.push_back(-0.0);
+
+    auto check = [](auto s) {
+        std::vector<typename decltype(s)::value_type> expected(s.cbegin(), s.cend());
+        std::stable_sort(expected.begin(), expected.end());
+        auto sorted = s.sorted();
+        REQUIRE(std::equal(sorted.cbegin(), sorted.cend(), expected.begin(), expected.end()));
+        std::reverse(expected.begin(), expected.end());
+        s.reverse_sort();
+        REQUIRE(std::equal(s.cbegin(), s.cend(), expected.begin(), expected.end()));
+    };
+    check(s2);
+    check(s3);
+    check(s4);
+    check(s5);
+
+    series<std::string> s6{ "b", "c", "a" };
+    s6.sort();
+    REQUIRE(s6 == series<std::string>{ "a", "b", "c" });
+
+    series<int> s7;
+    s7.sort();
+    REQUIRE(s7.empty());
+}
+
+TEST_CASE("memory_usage()", "[series]")
+{
+    series<double> s1;
+    REQUIRE(s1.memory_usage().capacity_bytes == 0);
+    for (int i = 0; i < 100; ++i) {
+        s1.push_back(i);
+    }
+    memory_stats m1 = s1.memory_usage();
+    REQUIRE(m1.logical_bytes == 100 * sizeof(double));
+    REQUIRE(m1.capacity_bytes == 128 * sizeof(double));
+    REQUIRE(m1.shared_bytes == 0);
+    REQUIRE(m1.out_of_line_bytes == 0);
+
+    // copies and slices share the buffer
+    series<double> s2 = s1;
+    REQUIRE(s1.memory_usage().shared_bytes == m1.capacity_bytes);
+    series<double> s3 = s1.slice(10, 20);
+    REQUIRE(s3.memory_usage().capacity_bytes == 10 * sizeof(double));
+    REQUIRE(s3.memory_usage().shared_bytes == 10 * sizeof(double));
+
+    // a shared buffer isn't compacted
+    s1.shrink_to_fit();
+    REQUIRE(s1.capacity() == 128);
+    s2 = series<double>{};
+    s3.shrink_to_fit();
+    REQUIRE(s3.memory_usage().shared_bytes == 0);
+    REQUIRE(s3.capacity() == 10);
+    REQUIRE(s3[0] == 10.0);
+    s1.shrink_to_fit();
+    REQUIRE(s1.capacity() == 100);
+    REQUIRE(s1.memory_usage().capacity_bytes == m1.logical_bytes);
+
+    series<std::string> s4;
+    s4.push_back("short");
+    s4.push_back(std::string(100, 'x'));
+    memory_stats m4 = s4.memory_usage();
+    REQUIRE(m4.logical_bytes == 2 * sizeof(std::string));
+    REQUIRE(m4.out_of_line_bytes > 100);
+    REQUIRE(m4.out_of_line_bytes < 200);
+}
+
+TEST_CASE("adopted buffers", "[series]")
+{
+    int deletes = 0;
+    {
+        double* buf = new double[4]{ 1.0, 2.0, 3.0, 4.0 };
+        series<double> s1(buf, 4, [&](double* p) {
+            ++deletes;
+            delete[] p;
+        });
+        const series<double>& cs1 = s1;
+        REQUIRE(cs1.data() == buf);
+        REQUIRE(cs1.size() == 4);
+        REQUIRE(cs1.mean() == 2.5);
+
+        series<double> s2 = s1.slice(1, 3);
+        series<double> s3 = s1;
+        s1                = series<double>{};
+        REQUIRE(deletes == 0);
+
+        // writing copies out of the adopted buffer
+        s3[0] = 10.0;
+        REQUIRE(buf[0] == 1.0);
+        REQUIRE(s3[0] == 10.0);
+        REQUIRE(deletes == 0);
+        REQUIRE(s2[1] == 3.0);
+        REQUIRE(deletes == 1);
+    }
+    REQUIRE(deletes == 1);
+
+    auto owner = std::make_shared<std::vector<int>>(std::vector<int>{ 1, 2, 3 });
+    series<int> s4(owner, owner->data(), owner->data() + owner->size());
+    REQUIRE(owner.use_count() == 2);
+    s4.push_back(4);
+    REQUIRE(owner.use_count() == 1);
+    REQUIRE(owner->size() == 3);
+    REQUIRE(s4.size() == 4);
+}
+
+TEST_CASE("nullable_series", "[series]")
+{
+    nullable_series<double> ns{ 1.0, missing, 3.0, missing, 5.0 };
+    REQUIRE(ns.size() == 5);
+    REQUIRE(ns.count() == 3);
+    REQUIRE(ns.count_missing() == 2);
+    REQUIRE(ns[0] == 1.0);
+    REQUIRE(!ns[1].has_value());
+    REQUIRE(ns.is_missing(3));
+    REQUIRE(ns.validity()[0] == 0b10101);
+    REQUIRE(ns.values()[1] == 0.0);
+    REQUIRE(ns.sum() == 9.0);
+    REQUIRE(ns.mean() == Approx(3.0));
+    auto [mn, mx] = ns.minmax();
+    REQUIRE(mn == 1.0);
+    REQUIRE(mx == 5.0);
+    REQUIRE_THROWS_AS(ns.at(5), std::out_of_range);
+
+    SECTION("drop_missing()")
+    {
+        series<double> dropped = ns.drop_missing();
+        REQUIRE(dropped == series<double>{ 1.0, 3.0, 5.0 });
+    }
+
+    SECTION("fill_forward()")
+    {
+        nullable_series<int> leading{ missing, missing, 2, missing, 4, missing };
+        auto filled = leading.fill_forward();
+        REQUIRE(filled.count() == 4);
+        REQUIRE(!filled[0].has_value());
+        REQUIRE(!filled[1].has_value());
+        REQUIRE(filled[3] == 2);
+        REQUIRE(filled[5] == 4);
+        REQUIRE(leading.count() == 2);
+    }
+
+    SECTION("set()")
+    {
+        ns.set(1, 2.0);
+        ns.set(4, missing);
+        REQUIRE(ns[1] == 2.0);
+        REQUIRE(!ns[4].has_value());
+        REQUIRE(ns.values()[4] == 0.0);
+        REQUIRE(ns.sum() == 6.0);
+    }
+
+    SECTION("conversions")
+    {
+        series<mi<double>> s1{ 1.0, missing, 3.0 };
+        s1.set_name("px");
+        nullable_series<double> ns1{ s1 };
+        REQUIRE(ns1.name() == "px");
+        REQUIRE(ns1.allow_missing() == s1);
+        REQUIRE(ns1.disallow_missing() == s1.disallow_missing());
+
+        series<int> s2{ 1, 2, 3 };
+        nullable_series<int> ns2{ s2 };
+        REQUIRE(ns2.count() == 3);
+        REQUIRE(ns2.drop_missing() == s2);
+    }
+
+    SECTION("runs across words")
+    {
+        nullable_series<int64_t> big;
+        int64_t expected = 0;
+        size_t present   = 0;
+        for (int64_t i = 0; i < 300; ++i) {
+            if (i % 7 == 3 || (i >= 64 && i < 128)) {
+                big.push_back(i);
+                expected += i;
+                ++present;
+            }
+            else {
+                big.push_back(missing);
+            }
+        }
+        REQUIRE(big.count() == present);
+        REQUIRE(big.sum() == expected);
+        REQUIRE(big.drop_missing().size() == present);
+        REQUIRE(big.fill_forward().count() == 297);
+
+        nullable_series<double> none{ missing, missing };
+        REQUIRE(!none.minmax().first.has_value());
+        REQUIRE(none.drop_missing().empty());
+    }
+}
+
+TEST_CASE("smi", "[series]")
+{
+    static_assert(sizeof(smi<double>) == sizeof(double));
+    static_assert(sizeof(smi<int64_t>) == sizeof(int64_t));
+
+    smi<double> d1{ 1.5 };
+    smi<double> d2{ missing };
+    smi<double> d3;
+    REQUIRE(d1.has_value());
+    REQUIRE(!d2.has_value());
+    REQUIRE(!d3.has_value());
+    REQUIRE(!smi<double>{ std::nan("") }.has_value());
+    REQUIRE(*d1 == 1.5);
+    REQUIRE(d1.value_or(0.0) == 1.5);
+    REQUIRE(d2.value_or(0.0) == 0.0);
+    REQUIRE_THROWS_AS(d2.value(), std::bad_optional_access);
+
+    REQUIRE(d1 == 1.5);
+    REQUIRE(d2 == missing);
+    REQUIRE(d2 == d3);
+    REQUIRE(d1 != d2);
+    REQUIRE(d2 < d1);
+    REQUIRE(d1 > missing);
+    REQUIRE(!(d1 + d2).has_value());
+    REQUIRE(d1 * 2.0 == 3.0);
+
+    smi<int32_t> i1{ 4 };
+    smi<int32_t> i2{ missing };
+    REQUIRE(*i2 == std::numeric_limits<int32_t>::min());
+    REQUIRE(!(i1 - i2).has_value());
+    REQUIRE(i1 / 2 == 2);
+    REQUIRE(smi<uint8_t>{ missing } == smi<uint8_t>{ uint8_t{ 255 } });
+
+    mi<double> m1 = d1;
+    REQUIRE(m1 == 1.5);
+    smi<double> d4{ mi<double>{} };
+    REQUIRE(d4 == missing);
+
+    series<smi<double>> s1{ 1.0, missing, 3.0, missing, 5.0, 6.0, missing, 8.0, 9.0 };
+    REQUIRE(s1.mean() == Approx(32.0 / 6.0));
+    REQUIRE(s1.allow_missing() == s1);
+    auto s2 = s1.disallow_missing();
+    REQUIRE(s2[1] == 0.0);
+    REQUIRE(s2[2] == 3.0);
+
+    std::stringstream ss;
+    ss << d2;
+    REQUIRE(ss.str() == "missing");
+}
+
+TEST_CASE("string_series", "[series]")
+{
+    string_series ss{ "carol", "alice", "bob", "", "alicia", "alice" };
+    ss.set_name("name");
+    REQUIRE(ss.size() == 6);
+    REQUIRE(ss.bytes() == 24);
+    REQUIRE(ss[0] == "carol");
+    REQUIRE(ss[3].empty());
+    REQUIRE(ss.at(4) == "alicia");
+    REQUIRE_THROWS_AS(ss.at(6), std::out_of_range);
+
+    SECTION("sort")
+    {
+        REQUIRE(ss.argsort() == std::vector<size_t>{ 3, 1, 5, 4, 2, 0 });
+        auto sorted = ss.sort();
+        REQUIRE(sorted.name() == "name");
+        REQUIRE(sorted.to_string() ==
+            std::vector<std::string>{ "", "alice", "alice", "alicia", "bob", "carol" });
+
+        // prefixes tie, the tails decide
+        string_series longer{ "prefix__b", "prefix__a", "prefix__", "prefix_" };
+        REQUIRE(longer.argsort() == std::vector<size_t>{ 3, 2, 1, 0 });
+    }
+
+    SECTION("copy on write")
+    {
+        string_series ss2 = ss;
+        REQUIRE(ss.use_count() == 2);
+        ss2.push_back("dave");
+        REQUIRE(ss.use_count() == 1);
+        REQUIRE(ss.size() == 6);
+        REQUIRE(ss2.size() == 7);
+        REQUIRE(ss2[6] == "dave");
+        REQUIRE(ss2[0] == "carol");
+        ss2.pop_back();
+        REQUIRE(ss2 == ss);
+    }
+
+    SECTION("conversions")
+    {
+        series<std::string> s1 = ss.to_series();
+        REQUIRE(s1.name() == "name");
+        REQUIRE(s1[4] == "alicia");
+        string_series ss2{ s1 };
+        REQUIRE(ss2 == ss);
+        REQUIRE(std::vector<std::string_view>(ss.begin(), ss.end()).size() == 6);
+    }
+
+    SECTION("alongside a frame")
+    {
+        using namespace mf::placeholders;
+        frame<int, double> f1;
+        for (int i = 0; i < 6; ++i) {
+            f1.push_back(i, i * 1.5);
+        }
+        auto sorted = f1.gather(ss.argsort());
+        REQUIRE(sorted.column(_0) == series<int>{ 3, 1, 5, 4, 2, 0 });
+
+        mask starts_a = ss.where([](std::string_view n) { return !n.empty() && n[0] == 'a'; });
+        REQUIRE(starts_a == mask{ false, true, false, false, true, true });
+        auto as = f1.filter(starts_a);
+        REQUIRE(as.column(_0) == series<int>{ 1, 4, 5 });
+    }
+}
+
+TEST_CASE("mask", "[series]")
+{
+    mask m1{ true, false, true, true, false };
+    REQUIRE(m1.size() == 5);
+    REQUIRE(m1.count() == 3);
+    REQUIRE(m1[0]);
+    REQUIRE(!m1[1]);
+    REQUIRE_THROWS_AS(m1.at(5), std::out_of_range);
+
+    mask m2{ false, false, true, false, true };
+    REQUIRE((m1 & m2) == mask{ false, false, true, false, false });
+    REQUIRE((m1 | m2) == mask{ true, false, true, true, true });
+    REQUIRE((m1 ^ m2) == mask{ true, false, false, true, true });
+    REQUIRE(~m1 == mask{ false, true, false, false, true });
+    REQUIRE((~m1).count() == 2);
+    REQUIRE_THROWS_AS(m1 & mask(4), std::invalid_argument);
+
+    mask big(130, true);
+    REQUIRE(big.count() == 130);
+    REQUIRE(big.all());
+    REQUIRE((~big).none());
+    big.set(64, false);
+    REQUIRE(big.count() == 129);
+    REQUIRE_THROWS_AS(big.set(130), std::out_of_range);
+    REQUIRE_THROWS_AS(m1.set(5), std::out_of_range);
+    REQUIRE(m1.count() == 3);
+    std::vector<size_t> unset;
+    (~big).for_each_set([&](size_t n) { unset.push_back(n); });
+    REQUIRE(unset == std::vector<size_t>{ 64 });
+
+    series<bool> s1{ true, false, true, true, false };
+    REQUIRE(mask{ s1 } == m1);
+    REQUIRE(m1.to_series() == s1);
+}
+
+TEST_CASE("rle_series", "[series]")
+{
+    series<year_month_day> dates;
+    for (int d = 1; d <= 5; ++d) {
+        for (int i = 0; i < 100; ++i) {
+            dates.push_back(2022_y / January / d);
+        }
+    }
+    dates.set_name("date");
+
+    rle_series<year_month_day> r1{ dates };
+    REQUIRE(r1.size() == 500);
+    REQUIRE(r1.num_runs() == 5);
+    REQUIRE(r1.name() == "date");
+    REQUIRE(r1[0] == 2022_y / January / 1);
+    REQUIRE(r1[199] == 2022_y / January / 2);
+    REQUIRE(r1[200] == 2022_y / January / 3);
+    REQUIRE(r1.at(499) == 2022_y / January / 5);
+    REQUIRE_THROWS_AS(r1.at(500), std::out_of_range);
+    REQUIRE(r1.run_length(2) == 100);
+    REQUIRE(r1.minmax() == std::make_pair(2022_y / January / 1, 2022_y / January / 5));
+    REQUIRE(r1.to_series() == dates);
+    REQUIRE(std::equal(r1.begin(), r1.end(), dates.begin(), dates.end()));
+
+    int calls = 0;
+    mask m    = r1.where([&](const year_month_day& d) {
+        ++calls;
+        return d >= 2022_y / January / 4;
+    });
+    REQUIRE(calls == 5);
+    REQUIRE(m.count() == 200);
+    REQUIRE(!m[299]);
+    REQUIRE(m[300]);
+
+    rle_series<int> r2{ 1, 1, 1, 4, 4, 2 };
+    REQUIRE(r2.num_runs() == 3);
+    REQUIRE(r2.mean() == Approx(13.0 / 6.0));
+    r2.push_back(2);
+    REQUIRE(r2.num_runs() == 3);
+    REQUIRE(r2.size() == 7);
+}
+
+TEST_CASE("delta_series", "[series]")
+{
+    series<int64_t> s1;
+    int64_t start = 1'650'000'000;
+    for (int64_t i = 0; i < 1000; ++i) {
+        s1.push_back(start + i * 3 + (i % 2));
+    }
+
+    delta_series<int64_t> d1{ s1 };
+    REQUIRE(d1.size() == 1000);
+    REQUIRE(d1.to_series() == s1);
+    REQUIRE(d1[0] == start);
+    REQUIRE(d1[999] == s1[999]);
+    REQUIRE(d1.at(128) == s1[128]);
+    REQUIRE_THROWS_AS(d1.at(1000), std::out_of_range);
+    REQUIRE(d1.encoded_bytes() < 1000 * sizeof(int64_t) / 3);
+    REQUIRE(d1.mean() == Approx(s1.mean()));
+    REQUIRE(d1.minmax() == s1.minmax());
+
+    mask m = d1.between(start + 300, start + 600);
+    size_t expected = 0;
+    for (int64_t v : s1) {
+        expected += (start + 300 <= v && v <= start + 600) ? 1 : 0;
+    }
+    REQUIRE(m.size() == 1000);
+    REQUIRE(m.count() == expected);
+
+    // selects the rows of a frame the column runs alongside
+    frame<int64_t> f1(s1);
+    auto window = f1.filter(m);
+    REQUIRE(window.size() == expected);
+    REQUIRE(window.column(mf::placeholders::_0).minmax().first >= start + 300);
+
+    // negative numbers and wide ranges
+    delta_series<int32_t> d2;
+    for (int32_t i = 0; i < 300; ++i) {
+        d2.push_back(i % 2 ? std::numeric_limits<int32_t>::min() + i
+                           : std::numeric_limits<int32_t>::max() - i);
+    }
+    REQUIRE(d2[1] == std::numeric_limits<int32_t>::min() + 1);
+    REQUIRE(d2[298] == std::numeric_limits<int32_t>::max() - 298);
+
+    // time points
+    delta_series<sys_days> d3;
+    for (int i = 0; i < 200; ++i) {
+        d3.push_back(sys_days{ 2022_y / January / 1 } + days{ i });
+    }
+    REQUIRE(year_month_day{ d3[31] } == 2022_y / February / 1);
+    REQUIRE(year_month_day{ d3.minmax().second } == 2022_y / July / 19);
+}
@@ -1009,3 +1009,254 @@ TEST_CASE("operator==", "[series_vector]")
     REQUIRE(f3 == "f3");
     REQUIRE(sv1 == sv2);
 }
+
+class counting_resource : public memory_resource
+{
+public:
+    size_t allocations   = 0;
+    size_t deallocations = 0;
+    size_t live_bytes    = 0;
+
+protected:
+    void*
+    do_allocate(size_t bytes, size_t alignment) override
+    {
+        ++allocations;
+        live_bytes += bytes;
+        return aligned_heap_resource()->allocate(bytes, alignment);
+    }
+
+    void
+    do_deallocate(void* p, size_t bytes, size_t alignment) override
+    {
+        ++deallocations;
+        live_bytes -= bytes;
+        aligned_heap_resource()->deallocate(p, bytes, alignment);
+    }
+};
+
+TEST_CASE("memory_resource", "[series_vector]")
+{
+    counting_resource res;
+    {
+        series_vector<double> sv1(&res);
+        REQUIRE(sv1.get_memory_resource() == &res);
+        for (int i = 0; i < 100; ++i) {
+            sv1.push_back(i * 1.5);
+        }
+        REQUIRE(reinterpret_cast<uintptr_t>(sv1.data()) % column_alignment == 0);
+        REQUIRE(res.allocations > 0);
+
+        series_vector<double> sv2(sv1);
+        REQUIRE(sv2.get_memory_resource() == &res);
+        REQUIRE(sv1 == sv2);
+
+        series_vector<double> sv3(std::move(sv2));
+        REQUIRE(sv3.get_memory_resource() == &res);
+        REQUIRE(sv1 == sv3);
+
+        series_vector<double> sv4(sv1, aligned_heap_resource());
+        REQUIRE(sv4.get_memory_resource() == aligned_heap_resource());
+        REQUIRE(sv1 == sv4);
+    }
+    REQUIRE(res.allocations == res.deallocations);
+    REQUIRE(res.live_bytes == 0);
+
+    series_vector<char> sv5;
+    sv5.push_back('a');
+    REQUIRE(sv5.get_memory_resource() == get_default_resource());
+    REQUIRE(reinterpret_cast<uintptr_t>(sv5.data()) % column_alignment == 0);
+}
+
+TEST_CASE("huge_page_resource", "[series_vector]")
+{
+    counting_resource upstream;
+    huge_page_resource::options opts;
+    opts.threshold = 1 << 16;
+    for (numa_placement placement :
+        { numa_placement::any, numa_placement::local, numa_placement::interleave,
+            numa_placement::node }) {
+        opts.placement = placement;
+        opts.pages     = placement == numa_placement::node ? huge_pages::hugetlb
+                                                           : huge_pages::transparent;
+        huge_page_resource res(opts, &upstream);
+        {
+            series_vector<double> sv1(&res);
+            for (int i = 0; i < 100; ++i) {
+                sv1.push_back(i);
+            }
+            REQUIRE(upstream.live_bytes > 0);
+
+            // past the threshold the block is mapped on a huge page boundary
+            for (int i = 100; i < 100000; ++i) {
+                sv1.push_back(i);
+            }
+            REQUIRE(upstream.live_bytes == 0);
+            REQUIRE(reinterpret_cast<uintptr_t>(sv1.data()) % (size_t{ 2 } << 20) == 0);
+            REQUIRE(sv1[0] == 0.0);
+            REQUIRE(sv1[99999] == 99999.0);
+            sv1.resize(10);
+            sv1.shrink_to_fit();
+            REQUIRE(upstream.live_bytes == 10 * sizeof(double));
+            REQUIRE(sv1[9] == 9.0);
+        }
+        REQUIRE(upstream.allocations == upstream.deallocations);
+    }
+}
+
+TEST_CASE("arena_resource", "[series_vector]")
+{
+    counting_resource upstream;
+    {
+        arena_resource arena(4096, &upstream);
+        series_vector<double> sv1(&arena);
+        sv1.push_back(1.0);
+        const double* first = sv1.data();
+        for (int i = 0; i < 100; ++i) {
+            sv1.push_back(i);
+        }
+        // the most recent block grows in place
+        REQUIRE(sv1.data() == first);
+        REQUIRE(reinterpret_cast<uintptr_t>(first) % column_alignment == 0);
+
+        series_vector<std::string> sv2(&arena);
+        sv2.push_back("one");
+        sv2.push_back("two");
+        REQUIRE(sv1.size() == 101);
+        REQUIRE(sv1[100] == 99.0);
+        REQUIRE(sv2[1] == "two");
+        REQUIRE(arena.bytes_used() > 101 * sizeof(double));
+        REQUIRE(upstream.allocations > 0);
+        REQUIRE(upstream.deallocations == 0);
+    }
+    REQUIRE(upstream.allocations == upstream.deallocations);
+    REQUIRE(upstream.live_bytes == 0);
+}
+
+TEST_CASE("trivially copyable", "[series_vector]")
+{
+    series_vector<int64_t> sv1;
+    for (int64_t i = 0; i < 1000; ++i) {
+        sv1.push_back(i);
+    }
+    REQUIRE(sv1.size() == 1000);
+    REQUIRE(sv1[999] == 999);
+
+    sv1.insert(sv1.cbegin() + 10, size_t{ 3 }, int64_t{ -1 });
+    REQUIRE(sv1.size() == 1003);
+    REQUIRE(sv1[9] == 9);
+    REQUIRE(sv1[10] == -1);
+    REQUIRE(sv1[12] == -1);
+    REQUIRE(sv1[13] == 10);
+
+    sv1.erase(sv1.cbegin() + 10, sv1.cbegin() + 13);
+    REQUIRE(sv1.size() == 1000);
+    for (int64_t i = 0; i < 1000; ++i) {
+        REQUIRE(sv1[i] == i);
+    }
+
+    series_vector<int64_t> sv2(sv1);
+    REQUIRE(sv1 == sv2);
+    sv2.clear();
+    sv2.push_back(4);
+    REQUIRE(sv2.size() == 1);
+
+    // Grow well past the size the default resource maps directly
+    series_vector<double> sv3;
+    const size_t num = 1 << 19;
+    for (size_t i = 0; i < num; ++i) {
+        sv3.push_back(static_cast<double>(i));
+    }
+    REQUIRE(sv3.size() == num);
+    REQUIRE(sv3.front() == 0.0);
+    REQUIRE(sv3[num / 2] == static_cast<double>(num / 2));
+    REQUIRE(sv3.back() == static_cast<double>(num - 1));
+    REQUIRE(reinterpret_cast<uintptr_t>(sv3.data()) % column_alignment == 0);
+}
+
+TEST_CASE("lazy storage", "[series_vector]")
+{
+    counting_resource res;
+    {
+        series_vector<double> sv1(&res);
+        REQUIRE(sv1.empty());
+        REQUIRE(sv1.capacity() == 0);
+        REQUIRE(sv1.begin() == sv1.end());
+
+        series_vector<double> sv2(std::move(sv1));
+        series_vector<double> sv3(sv2);
+        sv1 = std::move(sv3);
+        REQUIRE(res.allocations == 0);
+
+        sv2.push_back(1.0);
+        REQUIRE(res.allocations == 1);
+        REQUIRE(sv2.capacity() >= series_vector<double>::DEFAULT_SIZE);
+
+        series_vector<double> sv4(std::move(sv2));
+        REQUIRE(res.allocations == 1);
+        REQUIRE(sv2.empty());
+        REQUIRE(sv4.size() == 1);
+        sv2.push_back(2.0);
+        REQUIRE(sv2.size() == 1);
+        REQUIRE(sv2[0] == 2.0);
+    }
+    REQUIRE(res.allocations == res.deallocations);
+    REQUIRE(std::is_nothrow_move_constructible_v<series_vector<std::string>>);
+    REQUIRE(std::is_nothrow_move_assignable_v<series_vector<std::string>>);
+}
+
+TEST_CASE("shrink_to_fit", "[series_vector]")
+{
+    counting_resource res;
+    {
+        series_vector<double> sv1(&res);
+        for (int i = 0; i < 100; ++i) {
+            sv1.push_back(i);
+        }
+        REQUIRE(sv1.capacity() == 128);
+        sv1.shrink_to_fit();
+        REQUIRE(sv1.capacity() == 100);
+        REQUIRE(res.live_bytes == 100 * sizeof(double));
+        REQUIRE(sv1[99] == 99.0);
+
+        series_vector<std::string> sv2;
+        sv2.push_back("one");
+        sv2.push_back("a string too long for the small string buffer");
+        sv2.shrink_to_fit();
+        REQUIRE(sv2.capacity() == 2);
+        REQUIRE(sv2[1] == "a string too long for the small string buffer");
+
+        sv1.clear();
+        sv1.shrink_to_fit();
+        REQUIRE(sv1.capacity() == 0);
+        REQUIRE(res.live_bytes == 0);
+    }
+    REQUIRE(res.allocations == res.deallocations);
+}
+
+TEST_CASE("growth_policy", "[series_vector]")
+{
+    REQUIRE(get_growth_policy() == growth_policy::power_of_two);
+
+    growth_policy prev = set_growth_policy(growth_policy::exact);
+    REQUIRE(prev == growth_policy::power_of_two);
+    series_vector<int> sv1;
+    sv1.reserve(100);
+    REQUIRE(sv1.capacity() == 100);
+    sv1.push_back(1);
+    REQUIRE(sv1.capacity() == 100);
+    series_vector<int> sv2(size_t{ 10 });
+    REQUIRE(sv2.capacity() == 10);
+
+    set_growth_policy(growth_policy::factor_1_5);
+    sv1.resize(100);
+    sv1.push_back(2);
+    REQUIRE(sv1.capacity() == 150);
+    sv1.reserve(1000);
+    REQUIRE(sv1.capacity() == 1000);
+
+    set_growth_policy(prev);
+    series_vector<int> sv3;
+    sv3.reserve(100);
+    REQUIRE(sv3.capacity() == 128);
+}
@@ -2,8 +2,11 @@
 
 
 
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
 #include <map>
+#include <thread>
 #include <ostream>
 
 #define CATCH_CONFIG_MAIN
@@ -303,6 +306,16 @@ TEST_CASE("size()/clear()", "[frame]")
     REQUIRE(f1.size() == 1);
     f1.push_back(2022_y / January / 3, 11.0, true);
     REQUIRE(f1.size() == 2);
+
+    // a cleared frame keeps allocating from its resource
+    arena_resource arena;
+    frame<int, double> f2(&arena);
+    f2.push_back(1, 1.0);
+    f2.clear();
+    REQUIRE(f2.column(_1).get_memory_resource() == &arena);
+    f2.push_back(2, 2.0);
+    REQUIRE(f2.column(_0).get_memory_resource() == &arena);
+    REQUIRE(f2.column(_1).get_memory_resource() == &arena);
 }
 
 TEST_CASE("insert( pos first last )", "[frame]")
@@ -579,6 +592,82 @@ TEST_CASE("push_back() pop_back()", "[frame]")
     REQUIRE(f1.begin()->at(_2) == false);
 }
 
+TEST_CASE("append_columns()", "[frame]")
+{
+    frame<year_month_day, double, bool> f1;
+    f1.set_column_names("date", "temperature", "rain");
+    f1.push_back(2022_y / January / 1, 9.0, true);
+
+    std::vector<year_month_day> dates{ 2022_y / January / 2, 2022_y / January / 3 };
+    double temps[] = { 10.0, 11.1 };
+    series<bool> rain{ false, true };
+    f1.append_columns(dates, temps, rain);
+    REQUIRE(f1.size() == 3);
+    REQUIRE(f1.column_name(_1) == "temperature");
+    REQUIRE(f1.row(0).at(_0) == 2022_y / January / 1);
+    REQUIRE(f1.row(1).at(_0) == 2022_y / January / 2);
+    REQUIRE(f1.row(1).at(_1) == 10.0);
+    REQUIRE(f1.row(1).at(_2) == false);
+    REQUIRE(f1.row(2).at(_0) == 2022_y / January / 3);
+    REQUIRE(f1.row(2).at(_1) == 11.1);
+    REQUIRE(f1.row(2).at(_2) == true);
+
+    std::vector<double> short_temps{ 1.0 };
+    REQUIRE_THROWS_AS(f1.append_columns(dates, short_temps, rain), std::invalid_argument);
+    REQUIRE(f1.size() == 3);
+
+    std::vector<year_month_day> no_dates;
+    std::vector<double> no_temps;
+    std::vector<bool> no_rain;
+    f1.append_columns(no_dates, no_temps, no_rain);
+    REQUIRE(f1.size() == 3);
+}
+
+TEST_CASE("frame_builder", "[frame]")
+{
+    frame<int, std::string, double> f1;
+    f1.set_column_names("id", "symbol", "price");
+    {
+        frame_builder b(f1, 4);
+        for (int i = 0; i < 10; ++i) {
+            std::string sym = "sym" + std::to_string(i);
+            b.push_back(i, std::move(sym), i * 0.5);
+        }
+        // two full batches have been flushed, the rest are pending
+        REQUIRE(f1.size() == 8);
+        REQUIRE(b.pending() == 2);
+        b.flush();
+        REQUIRE(f1.size() == 10);
+        REQUIRE(b.pending() == 0);
+        b.push_back(10, "sym10", 5.0);
+    }
+    REQUIRE(f1.size() == 11);
+    for (int i = 0; i < 11; ++i) {
+        REQUIRE(f1.row(i).at(_0) == i);
+        REQUIRE(f1.row(i).at(_1) == "sym" + std::to_string(i));
+        REQUIRE(f1.row(i).at(_2) == i * 0.5);
+    }
+    REQUIRE(f1.column_name(_2) == "price");
+
+    // a value that throws as it's staged leaves no part of its row behind
+    struct bad_symbol
+    {
+        operator std::string() const { throw std::runtime_error{ "bad symbol" }; }
+    };
+    {
+        frame_builder b(f1, 4);
+        b.push_back(11, "sym11", 5.5);
+        REQUIRE_THROWS_AS(b.push_back(99, bad_symbol{}, 99.0), std::runtime_error);
+        REQUIRE(b.pending() == 1);
+        b.push_back(12, "sym12", 6.0);
+    }
+    REQUIRE(f1.size() == 13);
+    REQUIRE(f1.column(_0).size() == 13);
+    REQUIRE(f1.column(_1).size() == 13);
+    REQUIRE(f1.row(12).at(_0) == 12);
+    REQUIRE(f1.row(12).at(_1) == "sym12");
+}
+
 TEST_CASE("resize()", "[frame]")
 {
     SECTION("bigger")
@@ -923,6 +1012,190 @@ TEST_CASE("operator[Ex]", "[frame]")
     REQUIRE((flasthalf.begin() + 2)->at(_2) == false);
 }
 
+TEST_CASE("slice()", "[frame]")
+{
+    frame<year_month_day, double, bool> f1;
+    f1.set_column_names("date", "temperature", "rain");
+    f1.push_back(2022_y / January / 2, 10.0, false);
+    f1.push_back(2022_y / January / 3, 11.1, true);
+    f1.push_back(2022_y / January / 4, 12.2, false);
+    f1.push_back(2022_y / January / 5, 13.3, false);
+
+    const auto f2 = f1.slice(1, 3);
+    REQUIRE(f2.size() == 2);
+    REQUIRE(f2.column_name(_1) == "temperature");
+    REQUIRE(f2.cbegin()->at(_0) == 2022_y / January / 3);
+    REQUIRE(f2.cbegin()->at(_1) == 11.1);
+    REQUIRE((f2.cbegin() + 1)->at(_2) == false);
+    REQUIRE(&f2.cbegin()->at(_1) == &(f1.cbegin() + 1)->at(_1));
+    REQUIRE(f2.mean(_1) == Approx(11.65));
+
+    auto f3 = f1.slice(2, 4);
+    f3.begin()->at(_1) = 0.0;
+    REQUIRE(f3.row(0).at(_1) == 0.0);
+    REQUIRE(f1.row(2).at(_1) == 12.2);
+    f3.push_back(2022_y / January / 6, 14.4, true);
+    REQUIRE(f3.size() == 3);
+    REQUIRE(f1.size() == 4);
+
+    REQUIRE(f1.slice(0, 4) == f1);
+    REQUIRE(f1.slice(4, 4).empty());
+    REQUIRE_THROWS_AS(f1.slice(2, 5), std::out_of_range);
+}
+
+TEST_CASE("filter()", "[frame]")
+{
+    frame<year_month_day, double, bool> f1;
+    f1.set_column_names("date", "temperature", "rain");
+    for (int d = 1; d <= 100; ++d) {
+        year_month_day date{ sys_days{ 2022_y / January / 1 } + days{ d } };
+        f1.push_back(date, d * 0.5, d % 3 == 0);
+    }
+
+    mask warm = f1.make_mask(_1 > 25.0);
+    mask wet  = f1.make_mask(_2);
+    REQUIRE(warm.size() == 100);
+    REQUIRE(warm.count() == 50);
+    REQUIRE(wet.count() == 33);
+
+    auto f2 = f1.filter(warm & wet);
+    REQUIRE(f2.column_names() == f1.column_names());
+    REQUIRE(f2 == f1.rows(_1 > 25.0 && _2 == true));
+    REQUIRE(f2.size() == 17);
+
+    auto f3 = f1.filter(~warm);
+    REQUIRE(f3.size() == 50);
+    REQUIRE((f3.cend() - 1)->at(_1) == 25.0);
+
+    // reuse the same mask on a projection
+    auto f4 = f1.columns(_0, _1).filter(warm & ~wet);
+    REQUIRE(f4.size() == 33);
+
+    REQUIRE(f1.filter(mask(100)).empty());
+    REQUIRE_THROWS_AS(f1.filter(mask(10)), std::invalid_argument);
+}
+
+TEST_CASE("make_mask() column-wise", "[frame]")
+{
+    // Spans several mask blocks, and a partial last word
+    frame<int64_t, double, int32_t, std::string> f1;
+    for (int i = 0; i < 10003; ++i) {
+        f1.push_back(i, (i * 37) % 101 * 0.5, i % 7, std::to_string(i));
+    }
+
+    auto check = [&](auto ex, auto pred) {
+        mask m = f1.make_mask(ex);
+        REQUIRE(m.size() == f1.size());
+        size_t count = 0;
+        for (size_t i = 0; i < f1.size(); ++i) {
+            bool expected = pred((f1.cbegin() + i)->at(_0), (f1.cbegin() + i)->at(_1),
+                (f1.cbegin() + i)->at(_2));
+            REQUIRE(m[i] == expected);
+            count += expected;
+        }
+        auto f2 = f1.rows(ex);
+        REQUIRE(f2.size() == count);
+        size_t r = 0;
+        m.for_each_set([&](size_t i) {
+            REQUIRE((f2.cbegin() + r)->at(_0) == (f1.cbegin() + i)->at(_0));
+            REQUIRE((f2.cbegin() + r)->at(_1) == (f1.cbegin() + i)->at(_1));
+            REQUIRE((f2.cbegin() + r)->at(_2) == (f1.cbegin() + i)->at(_2));
+            REQUIRE((f2.cbegin() + r)->at(_3) == (f1.cbegin() + i)->at(_3));
+            ++r;
+        });
+    };
+
+    check(_1 > 20.0, [](int64_t, double b, int32_t) { return b > 20.0; });
+    check(20.0 >= _1, [](int64_t, double b, int32_t) { return 20.0 >= b; });
+    check(_0 < 9000, [](int64_t a, double, int32_t) { return a < 9000; });
+    check(_2 != 3, [](int64_t, double, int32_t c) { return c != 3; });
+    check(_1 > 1.0 && _2 == 0,
+        [](int64_t, double b, int32_t c) { return b > 1.0 && c == 0; });
+    check(_1 > 49.0 || _0 <= 5 || _2 == 6,
+        [](int64_t a, double b, int32_t c) { return b > 49.0 || a <= 5 || c == 6; });
+    check(!(_1 < 10.0) && _0 >= _2 * 1000,
+        [](int64_t a, double b, int32_t c) { return !(b < 10.0) && a >= c * 1000; });
+    check(_0 > _1, [](int64_t a, double b, int32_t) { return a > b; });
+    check(_0 % 64 == 63, [](int64_t a, double, int32_t) { return a % 64 == 63; });
+    check(_1 > _1[-1] && _0 > 0, [](int64_t a, double b, int32_t) {
+        return a > 0 && b > (((a - 1) * 37) % 101 * 0.5);
+    });
+    check(_0 >= 0, [](int64_t, double, int32_t) { return true; });
+    check(_0 < 0, [](int64_t, double, int32_t) { return false; });
+}
+
+TEST_CASE("where()", "[frame]")
+{
+    frame<int, double, std::string> f1;
+    f1.set_column_names("day", "temperature", "city");
+    for (int d = 0; d < 20; ++d) {
+        f1.push_back(d, 10.0 + (d * 7) % 13, d % 3 == 0 ? "Lima" : "Oslo");
+    }
+
+    auto v = f1.where(_1 > 15.0);
+    auto f2 = f1.rows(_1 > 15.0);
+    REQUIRE(v.size() == f2.size());
+    REQUIRE(v.materialize() == f2);
+    REQUIRE(v.materialize().column_names() == f1.column_names());
+    const auto& cf1 = f1;
+    REQUIRE(v.source().column(_0).data() == cf1.column(_0).data());
+
+    REQUIRE(v.mean(_1) == Approx(f2.mean(_1)));
+    REQUIRE(v.stddev(_1) == Approx(f2.stddev(_1)));
+    REQUIRE(v.corr(_0, _1) == Approx(f2.corr(_0, _1)));
+    REQUIRE(v.minmax(_1) == f2.minmax(_1));
+    REQUIRE(v.minmax(_2) == f2.minmax(_2));
+
+    size_t n = 0;
+    for (auto& row : v) {
+        REQUIRE(row.at(_1) > 15.0);
+        REQUIRE(row.at(_0) == (f2.cbegin() + n)->at(_0));
+        ++n;
+    }
+    REQUIRE(n == v.size());
+
+    SECTION("sort")
+    {
+        auto s = v.sorted(_2, _1);
+        REQUIRE(s.materialize() == f2.sorted(_2, _1));
+        REQUIRE(v.materialize() == f2);
+        REQUIRE(f1.size() == 20);
+        REQUIRE((s.cbegin() + 0)->at(_2) == "Lima");
+    }
+
+    SECTION("columns")
+    {
+        auto c = v.columns(_2, _0);
+        REQUIRE(c.materialize() == f2.columns(_2, _0));
+        REQUIRE(c.column(_1) == f2.column(_0));
+        REQUIRE(c.column_name<0>() == "city");
+    }
+
+    SECTION("groupby")
+    {
+        auto g1 = v.groupby(_2).aggregate(agg::mean(_1), agg::count());
+        auto g2 = f2.groupby(_2).aggregate(agg::mean(_1), agg::count());
+        g1.sort(_0);
+        g2.sort(_0);
+        REQUIRE(g1 == g2);
+    }
+
+    SECTION("where on a view")
+    {
+        auto w = v.where(_2 == std::string{ "Oslo" });
+        REQUIRE(w.materialize() == f1.rows(_1 > 15.0 && _2 == std::string{ "Oslo" }));
+    }
+
+    SECTION("source modified")
+    {
+        f1.column(_1)[v.selection()[0]] = 0.0;
+        REQUIRE(v.materialize() == f2);
+    }
+
+    REQUIRE(f1.where(_0 > 100).empty());
+    REQUIRE_THROWS_AS((frame_view<int, double, std::string>{ f1, { 20 } }), std::out_of_range);
+}
+
 TEST_CASE("row and column indexers combined", "[frame]")
 {
     frame<year_month_day, double, bool> f1;
@@ -1861,6 +2134,66 @@ TEST_CASE("disallow_missing()", "[frame]")
     }
 }
 
+TEST_CASE("sentinel missing", "[frame]")
+{
+    frame<year_month_day, smi<double>, smi<int32_t>> f1;
+    f1.set_column_names("date", "temperature", "rain");
+    f1.push_back(2022_y / January / 1, 8.0, 1);
+    f1.push_back(2022_y / January / 2, missing, 2);
+    f1.push_back(2022_y / January / 3, 10.0, missing);
+    f1.push_back(2022_y / January / 4, 12.0, 4);
+    f1.push_back(2022_y / January / 5, missing, missing);
+    f1.push_back(2022_y / January / 6, 14.0, 6);
+
+    static_assert(sizeof(smi<double>) == sizeof(double));
+    REQUIRE(f1.mean(_1) == Approx(11.0));
+    REQUIRE(f1.stddev(_1) == Approx(std::sqrt(5.0)));
+    REQUIRE(f1.mean(_2) == Approx(13.0 / 4.0));
+    REQUIRE(f1.corr(_1, _1) == Approx(1.0));
+    REQUIRE(f1.drop_missing().size() == 3);
+
+    SECTION("allow_missing()")
+    {
+        auto f2 = f1.allow_missing();
+        static_assert(std::is_same<decltype(f2),
+            frame<mi<year_month_day>, smi<double>, smi<int32_t>>>::value);
+        REQUIRE(f2.size() == 6);
+        REQUIRE((f2.cbegin() + 1)->at(_1) == missing);
+    }
+
+    SECTION("disallow_missing()")
+    {
+        auto f2 = f1.disallow_missing(_1);
+        static_assert(
+            std::is_same<decltype(f2), frame<year_month_day, double, smi<int32_t>>>::value);
+        REQUIRE((f2.cbegin() + 1)->at(_1) == 0.0);
+        REQUIRE((f2.cbegin() + 3)->at(_1) == 12.0);
+        REQUIRE((f2.cbegin() + 2)->at(_2) == missing);
+
+        auto f3 = f1.disallow_missing();
+        static_assert(std::is_same<decltype(f3), frame<year_month_day, double, int32_t>>::value);
+        REQUIRE((f3.cbegin() + 4)->at(_2) == 0);
+    }
+
+    SECTION("longer than a vector")
+    {
+        frame<smi<double>, smi<double>> f2;
+        double ysum = 0.0;
+        int yn      = 0;
+        for (int i = 0; i < 37; ++i) {
+            smi<double> x = i % 5 == 0 ? smi<double>{ missing } : smi<double>{ double(i) };
+            smi<double> y = i % 7 == 0 ? smi<double>{ missing } : smi<double>{ 2.0 * i + 1.0 };
+            if (y.has_value()) {
+                ysum += *y;
+                ++yn;
+            }
+            f2.push_back(x, y);
+        }
+        REQUIRE(f2.corr(_0, _1) == Approx(1.0));
+        REQUIRE(f2.mean(_1) == Approx(ysum / yn));
+    }
+}
+
 TEST_CASE("expression offsets", "[frame]")
 {
     SECTION("initially allow missing")
@@ -2308,6 +2641,262 @@ TEST_CASE("std::sort", "[frame]")
     }
 }
 
+TEST_CASE("argsort() and gather()", "[frame]")
+{
+    frame<int, double, std::string> f1;
+    f1.set_column_names("id", "price", "venue");
+    f1.push_back(3, 10.5, "X");
+    f1.push_back(1, 10.25, "Y");
+    f1.push_back(2, 10.5, "Z");
+    f1.push_back(4, 10.25, "X");
+    f1.push_back(0, 10.75, "Y");
+
+    auto order = f1.argsort(_1);
+    REQUIRE(order == std::vector<size_t>{ 1, 3, 0, 2, 4 });
+    REQUIRE(f1.argsort(_2, _0) == std::vector<size_t>{ 0, 3, 4, 1, 2 });
+
+    // the same order applies to another frame with the same rows
+    frame<int> fills;
+    fills.append_columns(std::vector<int>{ 30, 10, 20, 40, 0 });
+    auto g = fills.gather(order);
+    REQUIRE((g.cbegin() + 0)->at(_0) == 10);
+    REQUIRE((g.cbegin() + 4)->at(_0) == 0);
+
+    auto f2 = f1.gather(order);
+    REQUIRE(f2 == f1.sorted(_1));
+    REQUIRE(f2.column_names() == f1.column_names());
+    REQUIRE((f2.cbegin() + 2)->at(_2) == "X");
+    REQUIRE(f1.gather({ 4, 4 }).size() == 2);
+    REQUIRE(f1.gather({}).empty());
+    REQUIRE_THROWS_AS(f1.gather({ 5 }), std::out_of_range);
+
+    auto f3 = f1;
+    f3.sort(_1, _0);
+    REQUIRE((f3.cbegin() + 0)->at(_0) == 1);
+    REQUIRE((f3.cbegin() + 1)->at(_0) == 4);
+    REQUIRE((f3.cbegin() + 2)->at(_0) == 2);
+    REQUIRE((f3.cbegin() + 3)->at(_0) == 3);
+    REQUIRE((f3.cbegin() + 4)->at(_2) == "Y");
+    REQUIRE(f3.column_name<2>() == "venue");
+    REQUIRE((f1.cbegin() + 0)->at(_0) == 3);
+
+    f3.reverse_sort(_1, _0);
+    REQUIRE(f3 == f1.reverse_sorted(_1, _0));
+    REQUIRE((f3.cbegin() + 0)->at(_0) == 0);
+    REQUIRE((f3.cbegin() + 1)->at(_0) == 3);
+    REQUIRE((f3.cbegin() + 4)->at(_0) == 1);
+
+    frame<int, double> empty;
+    empty.sort(_0);
+    REQUIRE(empty.argsort(_1).empty());
+}
+
+TEST_CASE("radix sort", "[frame]")
+{
+    // enough rows to take the radix path, with plenty of duplicate keys so
+    // that stability shows
+    const size_t num = 5000;
+    frame<int64_t, double, year_month_day, int16_t, std::string> f1;
+    for (size_t i = 0; i < num; ++i) {
+        int64_t id = static_cast<int64_t>((i * 7919) % 1201) - 600;
+        double px  = static_cast<double>(static_cast<int64_t>((i * 104729) % 97) - 48) / 4.0;
+        if (i % 101 == 0) {
+            px = -0.0;
+        }
+        auto day = sys_days{ 2022_y / January / 1 } + days{ static_cast<int>((i * 31) % 400) };
+        int16_t q = static_cast<int16_t>(static_cast<int>((i * 13) % 61) - 30);
+        f1.push_back(id, px, year_month_day{ day }, q, std::to_string(i % 17));
+    }
+
+    auto reference = [&](auto less) {
+        std::vector<size_t> order(num);
+        for (size_t i = 0; i < num; ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t l, size_t r) {
+            return less(f1.row(l), f1.row(r));
+        });
+        return order;
+    };
+
+    REQUIRE(f1.argsort(_0) ==
+        reference([](const auto& l, const auto& r) { return l.at(_0) < r.at(_0); }));
+    REQUIRE(f1.argsort(_1) ==
+        reference([](const auto& l, const auto& r) { return l.at(_1) < r.at(_1); }));
+    REQUIRE(f1.argsort(_2) ==
+        reference([](const auto& l, const auto& r) { return l.at(_2) < r.at(_2); }));
+
+    // packed into one 64-bit key
+    REQUIRE(f1.argsort(_3, _2) == reference([](const auto& l, const auto& r) {
+        return std::make_tuple(l.at(_3), l.at(_2)) < std::make_tuple(r.at(_3), r.at(_2));
+    }));
+
+    // too wide to pack into 64 bits, so compared row by row
+    REQUIRE(f1.argsort(_1, _0) == reference([](const auto& l, const auto& r) {
+        return std::make_tuple(l.at(_1), l.at(_0)) < std::make_tuple(r.at(_1), r.at(_0));
+    }));
+
+    // strings fall back to the comparison sort
+    REQUIRE(f1.argsort(_4, _3) == reference([](const auto& l, const auto& r) {
+        return std::make_tuple(l.at(_4), l.at(_3)) < std::make_tuple(r.at(_4), r.at(_3));
+    }));
+
+    auto f2 = f1.reverse_sorted(_2, _3);
+    REQUIRE(f2 ==
+        f1.gather(reference([](const auto& l, const auto& r) {
+            return std::make_tuple(l.at(_2), l.at(_3)) > std::make_tuple(r.at(_2), r.at(_3));
+        })));
+
+    auto f3 = f1;
+    f3.sort(_1);
+    REQUIRE(f3 == f1.gather(f1.argsort(_1)));
+    REQUIRE(std::is_sorted(f3.column(_1).cbegin(), f3.column(_1).cend()));
+
+    auto v = f1.where(_3 > 0).sorted(_0);
+    std::vector<size_t> expected;
+    for (size_t r : f1.argsort(_0)) {
+        if ((f1.cbegin() + static_cast<ptrdiff_t>(r))->at(_3) > 0) {
+            expected.push_back(r);
+        }
+    }
+    REQUIRE(v.selection() == expected);
+}
+
+TEST_CASE("parallel sort", "[frame]")
+{
+    // enough rows for several threads to get a share
+    const size_t num = 140000;
+    frame<int32_t, double, std::string> f1;
+    f1.reserve(num);
+    for (size_t i = 0; i < num; ++i) {
+        int32_t id = static_cast<int32_t>((i * 7919) % 5003);
+        double px  = static_cast<double>((i * 104729) % 211) / 2.0;
+        f1.push_back(id, px, std::to_string(i % 23));
+    }
+
+    for (unsigned threads : { 2u, 3u, 4u, 7u }) {
+        parallel p{ threads };
+        REQUIRE(f1.argsort(p, _0) == f1.argsort(_0));
+        REQUIRE(f1.argsort(p, _1, _0) == f1.argsort(_1, _0));
+        REQUIRE(f1.argsort(p, _2, _0) == f1.argsort(_2, _0));
+        REQUIRE(f1.sorted(p, _1) == f1.sorted(_1));
+        REQUIRE(f1.reverse_sorted(p, _2, _1) == f1.reverse_sorted(_2, _1));
+
+        auto f2 = f1;
+        f2.sort(p, _0, _1);
+        REQUIRE(f2 == f1.sorted(_0, _1));
+        f2.reverse_sort(p, _1);
+        REQUIRE(f2 == f1.sorted(_0, _1).reverse_sorted(_1));
+        REQUIRE(f2.column_names() == f1.column_names());
+
+        auto v = f1.where(_0 < 2500);
+        REQUIRE(v.sorted(p, _2).selection() == v.sorted(_2).selection());
+    }
+
+    // a merge sort over more threads than elements still sorts stably
+    std::vector<std::pair<int, int>> data{ { 3, 0 }, { 1, 1 }, { 3, 2 }, { 2, 3 }, { 1, 4 } };
+    std::vector<std::pair<int, int>> tmp(data.size());
+    auto by_first = [](const auto& l, const auto& r) { return l.first < r.first; };
+    mf::detail::parallel_merge_sort(data.data(), tmp.data(), data.size(), 8, by_first,
+        [&](auto* first, auto* last, auto*) { std::stable_sort(first, last, by_first); });
+    REQUIRE(data ==
+        std::vector<std::pair<int, int>>{ { 1, 1 }, { 1, 4 }, { 2, 3 }, { 3, 0 }, { 3, 2 } });
+
+    frame<int> empty;
+    empty.sort(parallel{ 4 }, _0);
+    REQUIRE(empty.argsort(parallel{}, _0).empty());
+}
+
+TEST_CASE("sort_keys", "[frame]")
+{
+    // long strings that share their first 15 bytes need the tie-break
+    const size_t num = 3000;
+    frame<std::string, mi<int>, double, int64_t> f1;
+    for (size_t i = 0; i < num; ++i) {
+        std::string venue = (i % 3 == 0 ? "a-very-long-venue-name-" : "v") + std::to_string(i % 7);
+        mi<int> lot       = i % 5 == 0 ? mi<int>{} : mi<int>{ static_cast<int>((i * 31) % 11) - 5 };
+        double px         = static_cast<double>(static_cast<int64_t>((i * 104729) % 97) - 48) / 4.0;
+        f1.push_back(venue, lot, px, static_cast<int64_t>((i * 7919) % 1201) - 600);
+    }
+
+    auto reference = [&](auto less) {
+        std::vector<size_t> order(num);
+        std::iota(order.begin(), order.end(), size_t{ 0 });
+        std::stable_sort(order.begin(), order.end(), [&](size_t l, size_t r) {
+            return less(f1.row(l), f1.row(r));
+        });
+        return order;
+    };
+    auto by_venue_lot = [](const auto& l, const auto& r) {
+        return std::make_tuple(l.at(_0), l.at(_1)) < std::make_tuple(r.at(_0), r.at(_1));
+    };
+    auto by_lot_px_id = [](const auto& l, const auto& r) {
+        if (l.at(_1) != r.at(_1)) {
+            return l.at(_1) < r.at(_1);
+        }
+        return std::make_tuple(l.at(_2), l.at(_3)) < std::make_tuple(r.at(_2), r.at(_3));
+    };
+
+    REQUIRE(f1.argsort(_0, _1) == reference(by_venue_lot));
+    REQUIRE(f1.argsort(_1, _2, _3) == reference(by_lot_px_id));
+    REQUIRE(f1.argsort(_2, _3) == reference([](const auto& l, const auto& r) {
+        return std::make_tuple(l.at(_2), l.at(_3)) < std::make_tuple(r.at(_2), r.at(_3));
+    }));
+    REQUIRE(f1.argsort(parallel{ 3 }, _0, _1) == f1.argsort(_0, _1));
+    REQUIRE(f1.reverse_sorted(_0, _1) ==
+        f1.gather(reference([&](const auto& l, const auto& r) { return by_venue_lot(r, l); })));
+
+    auto keys  = f1.make_sort_keys(_0, _1);
+    auto order = keys.argsort();
+    REQUIRE(keys.size() == num);
+    REQUIRE(keys.width == 16 + 5);
+    REQUIRE(order == f1.argsort(_0, _1));
+    REQUIRE(keys.argsort(parallel{ 2 }) == order);
+    for (size_t i = 1; i < num; ++i) {
+        REQUIRE(keys.compare(order[i - 1], order[i]) <= 0);
+    }
+
+    // lookups in sorted order
+    size_t first = keys.lower_bound(order, "v1", mi<int>{ 0 });
+    size_t last  = keys.upper_bound(order, "v1", mi<int>{ 3 });
+    size_t count = 0;
+    for (size_t r = 0; r < num; ++r) {
+        const auto& row = f1.row(r);
+        if (row.at(_0) == "v1" && row.at(_1).has_value() && *row.at(_1) >= 0 &&
+            *row.at(_1) <= 3) {
+            ++count;
+        }
+    }
+    REQUIRE(last - first == count);
+    REQUIRE(count > 0);
+    REQUIRE(keys.lower_bound(order, "", mi<int>{}) == 0);
+    REQUIRE(keys.upper_bound(order, "zzz", mi<int>{ 0 }) == num);
+
+    // keys of another frame compare against these, e.g. for a merge join
+    frame<std::string, mi<int>> f2;
+    f2.push_back("a-very-long-venue-name-3", mi<int>{ 2 });
+    f2.push_back("a-very-long-venue-name-4", missing);
+    auto keys2 = f2.make_sort_keys(_0, _1);
+    size_t r3  = *std::find_if(order.begin(), order.end(), [&](size_t r) {
+        return f1.row(r).at(_0) == "a-very-long-venue-name-3" && f1.row(r).at(_1) == 2;
+    });
+    REQUIRE(keys.compare(r3, keys2, 0) == 0);
+    REQUIRE(keys.compare(r3, keys2, 1) < 0);
+    REQUIRE(keys2.compare(1, keys, r3) > 0);
+
+    // a string sorts before longer ones it's a prefix of, embedded zeros
+    // included
+    frame<std::string> f3;
+    f3.push_back(std::string{ "ab\0", 3 });
+    f3.push_back("ab");
+    f3.push_back("a");
+    auto k3 = f3.make_sort_keys(_0);
+    REQUIRE(k3.argsort() == std::vector<size_t>{ 2, 1, 0 });
+
+    REQUIRE_THROWS_AS((sort_keys<int, int>{ series<int>{ 1 }, series<int>{ 1, 2 } }),
+        std::invalid_argument);
+}
+
 TEST_CASE("aggregate", "[frame]")
 {
     frame<year_month_day, double, float, float> f1;
@@ -4165,3 +4754,324 @@ TEST_CASE("operator()", "[frame]")
 //    (void)res;
 //}
 
+
+TEST_CASE("memory_usage()", "[frame]")
+{
+    frame<int32_t, double, std::string> f1;
+    for (int i = 0; i < 40; ++i) {
+        f1.push_back(i, i * 0.5, std::to_string(i));
+    }
+    memory_stats m1 = f1.memory_usage();
+    REQUIRE(m1.logical_bytes == 40 * (sizeof(int32_t) + sizeof(double) + sizeof(std::string)));
+    REQUIRE(m1.capacity_bytes == 64 * (sizeof(int32_t) + sizeof(double) + sizeof(std::string)));
+    REQUIRE(m1.shared_bytes == 0);
+    REQUIRE(m1.out_of_line_bytes == 0);
+
+    frame<int32_t, double, std::string> f2 = f1;
+    REQUIRE(f1.memory_usage().shared_bytes == m1.capacity_bytes);
+    f2.clear();
+
+    f1.shrink_to_fit();
+    memory_stats m2 = f1.memory_usage();
+    REQUIRE(m2.capacity_bytes == m2.logical_bytes);
+    REQUIRE(m2.logical_bytes == m1.logical_bytes);
+    REQUIRE((f1.cbegin() + 39)->at(_2) == "39");
+}
+
+TEST_CASE("frame from series", "[frame]")
+{
+    int64_t* ids = new int64_t[3]{ 7, 8, 9 };
+    bool freed   = false;
+    series<int64_t> s1(ids, 3, [&](int64_t* p) {
+        freed = true;
+        delete[] p;
+    });
+    s1.set_name("id");
+    series<double> s2{ 1.5, 2.5, 3.5 };
+    s2.set_name("price");
+
+    {
+        frame<int64_t, double> f1(s1, s2);
+        REQUIRE(f1.size() == 3);
+        REQUIRE(f1.column_name<0>() == "id");
+        REQUIRE(f1.column(_0).use_count() == 2);
+        REQUIRE((f1.cbegin() + 2)->at(_0) == 9);
+        REQUIRE((f1.cbegin() + 2)->at(_1) == 3.5);
+        s1 = series<int64_t>{};
+        REQUIRE(!freed);
+    }
+    REQUIRE(freed);
+
+    series<double> s3{ 1.0 };
+    REQUIRE_THROWS_AS((frame<int64_t, double>(s1, s3)), std::logic_error);
+}
+
+TEST_CASE("map_frame()", "[frame]")
+{
+    std::string path = (std::filesystem::temp_directory_path() / "mainframe_map_frame.mf").string();
+
+    frame<year_month_day, double, mi<int>> f1;
+    f1.set_column_names("date", "temp", "rain");
+    for (int d = 0; d < 1000; ++d) {
+        f1.push_back(year_month_day{ sys_days{ 2022_y / January / 1 } + days{ d } }, d * 0.5,
+            d % 3 == 0 ? mi<int>{} : mi<int>{ d });
+    }
+    write_frame(f1, path);
+
+    {
+        auto f2 = map_frame<year_month_day, double, mi<int>>(path);
+        REQUIRE(f2 == f1);
+        REQUIRE(f2.column_name<0>() == "date");
+        REQUIRE(f2.mean(_1) == f1.mean(_1));
+        REQUIRE(f2.memory_usage().shared_bytes == f2.memory_usage().capacity_bytes);
+
+        // writing copies the column out of the mapping
+        f2.column(_1)[0] = -1.0;
+        REQUIRE(f2.column(_1).memory_usage().shared_bytes == 0);
+        REQUIRE((f2.cbegin() + 0)->at(_1) == -1.0);
+        REQUIRE((f2.cbegin() + 0)->at(_0) == 2022_y / January / 1);
+        REQUIRE(map_frame<year_month_day, double, mi<int>>(path) == f1);
+
+        // columns outlive the frame they were mapped with
+        series<double> temp = map_frame<year_month_day, double, mi<int>>(path).column(_1);
+        REQUIRE(temp[999] == 499.5);
+    }
+
+    frame<int, double> empty;
+    write_frame(empty, path);
+    REQUIRE(map_frame<int, double>(path).empty());
+
+    write_frame(f1, path);
+    REQUIRE_THROWS_AS((map_frame<year_month_day, double>(path)), std::runtime_error);
+    REQUIRE_THROWS_AS((map_frame<year_month_day, int, mi<int>>(path)), std::runtime_error);
+    std::remove(path.c_str());
+    REQUIRE_THROWS_AS((map_frame<int>(path)), std::system_error);
+}
+
+TEST_CASE("publish_frame()", "[frame]")
+{
+    std::string name = "/mainframe_publish_frame_test";
+
+    frame<int, double> f1;
+    f1.set_column_names("id", "price");
+    for (int i = 0; i < 500; ++i) {
+        f1.push_back(i, i * 1.5);
+    }
+    publish_frame(f1, name);
+
+    auto f2 = attach_frame<int, double>(name);
+    REQUIRE(f2 == f1);
+    REQUIRE(f2.column_name<1>() == "price");
+    REQUIRE(f2.memory_usage().shared_bytes == f2.memory_usage().capacity_bytes);
+
+    // republishing leaves existing attachments alone
+    f1.push_back(500, 750.0);
+    publish_frame(f1, name);
+    REQUIRE(f2.size() == 500);
+    REQUIRE(attach_frame<int, double>(name) == f1);
+    REQUIRE_THROWS_AS((attach_frame<int, int>(name)), std::runtime_error);
+
+    unpublish_frame(name);
+    REQUIRE((f2.cbegin() + 499)->at(_1) == 748.5);
+    REQUIRE_THROWS_AS((attach_frame<int, double>(name)), std::system_error);
+}
+
+TEST_CASE("arena_scope", "[frame]")
+{
+    frame<int, double> f1;
+    f1.set_column_names("key", "value");
+    for (int i = 0; i < 1000; ++i) {
+        f1.push_back(i % 10, i * 0.5);
+    }
+
+    memory_resource* outer = get_default_resource();
+    frame<int, double> result;
+    {
+        arena_scope arena;
+        REQUIRE(get_default_resource() == &arena.resource());
+
+        auto f2 = f1.rows(_0 < 5);
+        auto f3 = f2.reversed();
+        REQUIRE(f3.column(_0).get_memory_resource() == &arena.resource());
+        REQUIRE(arena.resource().bytes_used() >= 500 * (sizeof(int) + sizeof(double)));
+
+        // other threads keep the process-wide default
+        memory_resource* other = nullptr;
+        std::thread t([&] { other = get_default_resource(); });
+        t.join();
+        REQUIRE(other == outer);
+
+        {
+            arena_scope inner;
+            series<double> s = f3.column(_1) * 2.0;
+            REQUIRE(s.get_memory_resource() == &inner.resource());
+            series<double> p = inner.promote(s);
+            REQUIRE(p.get_memory_resource() == &arena.resource());
+            REQUIRE(p == s);
+        }
+        REQUIRE(get_default_resource() == &arena.resource());
+
+        result = arena.promote(f3);
+        REQUIRE(result == f3);
+        REQUIRE(result.column_name<1>() == "value");
+    }
+    REQUIRE(get_default_resource() == outer);
+    REQUIRE(result.column(_0).get_memory_resource() == outer);
+    REQUIRE(result.size() == 500);
+    REQUIRE((result.cbegin() + 0)->at(_1) == 497.0);
+    result.push_back(1, 1.0);
+    REQUIRE(result.size() == 501);
+
+    // frames and series created outside the scope, or cleared, are first
+    // filled inside it but must outlive it
+    frame<int, double> acc;
+    series<std::string> names;
+    series<int> cleared{ 1, 2, 3 };
+    cleared.clear();
+    {
+        arena_scope arena;
+        for (int i = 0; i < 100; ++i) {
+            acc.push_back(i, i * 2.0);
+            names.push_back("name " + std::to_string(i));
+            cleared.push_back(i);
+        }
+        REQUIRE(acc.column(_0).get_memory_resource() == outer);
+        REQUIRE(arena.resource().bytes_used() == 0);
+    }
+    REQUIRE(acc.size() == 100);
+    REQUIRE((acc.cbegin() + 99)->at(_1) == 198.0);
+    REQUIRE(names[42] == "name 42");
+    REQUIRE(cleared.get_memory_resource() == outer);
+    REQUIRE(cleared[99] == 99);
+}
+
+TEST_CASE("row_frame", "[frame]")
+{
+    row_frame<int64_t, double, int32_t> book;
+    book.set_column_names("ts", "price", "qty");
+    book.push_back(3, 101.5, 100);
+    book.push_back(1, 101.25, 300);
+    book.push_back(2, 101.75, 200);
+    book.push_back(4, 101.25, 50);
+    REQUIRE(book.size() == 4);
+    REQUIRE(book.row(1).at(_1) == 101.25);
+    REQUIRE((book.cbegin() + 2)->at(_2) == 200);
+    REQUIRE((book.crbegin())->at(_0) == 4);
+    REQUIRE(std::is_trivially_copyable<decltype(book)::row_type>::value);
+
+    book.row(3).at(_2) = 60;
+    REQUIRE(book.row(3).at(_2) == 60);
+
+    auto copy = book;
+    book.sort(_1, _0);
+    REQUIRE(book.row(0).at(_0) == 1);
+    REQUIRE(book.row(1).at(_0) == 4);
+    REQUIRE(book.row(3).at(_0) == 2);
+    REQUIRE(copy.row(0).at(_0) == 3);
+    REQUIRE(copy.sorted(_1, _0) == book);
+
+    auto big = copy.rows(_2 >= 100 && _0[1] > _0);
+    REQUIRE(big.size() == 2);
+    REQUIRE(big.row(0).at(_0) == 1);
+    REQUIRE(big.row(1).at(_0) == 2);
+    REQUIRE(big.column_name<2>() == "qty");
+
+    frame<int64_t, double, int32_t> f = copy.to_frame();
+    REQUIRE(f.size() == 4);
+    REQUIRE(f.column_name<1>() == "price");
+    REQUIRE(f.rows(_2 >= 100 && _0[1] > _0) == big.to_frame());
+    REQUIRE(row_frame<int64_t, double, int32_t>{ f } == copy);
+    REQUIRE(row_frame<int64_t, double, int32_t>{ f }.column_names() == copy.column_names());
+}
+
+TEST_CASE("categorical", "[frame]")
+{
+    static_assert(sizeof(categorical) == sizeof(int32_t));
+
+    categorical a1{ "AAPL" };
+    categorical a2{ std::string{ "AAPL" } };
+    categorical m1{ "MSFT" };
+    REQUIRE(a1 == a2);
+    REQUIRE(a1.code() == a2.code());
+    REQUIRE(a1 != m1);
+    REQUIRE(a1 < m1);
+    REQUIRE(a1 == "AAPL");
+    REQUIRE("MSFT" == m1);
+    REQUIRE(a1.str() == "AAPL");
+    REQUIRE(categorical{} == "");
+    REQUIRE(std::hash<categorical>{}(a1) == std::hash<categorical>{}(a2));
+
+    size_t before = categorical::num_categories();
+    REQUIRE(a1 != "not interned");
+    REQUIRE(categorical::num_categories() == before);
+
+    // codes stay valid as the dictionary grows, including from other threads
+    std::vector<categorical> many;
+    for (int i = 0; i < 5000; ++i) {
+        many.emplace_back("category " + std::to_string(i));
+    }
+    int mismatches = 0;
+    std::thread reader([&] {
+        for (int i = 0; i < 5000; ++i) {
+            mismatches += many[i].str() != "category " + std::to_string(i);
+        }
+    });
+    for (int i = 5000; i < 10000; ++i) {
+        categorical c{ "category " + std::to_string(i) };
+        REQUIRE(c.str() == "category " + std::to_string(i));
+    }
+    reader.join();
+    REQUIRE(mismatches == 0);
+    REQUIRE(categorical::num_categories() > 10000);
+    REQUIRE(many[0] < many[1]);
+    REQUIRE(many[10] < many[2]);
+
+    frame<categorical, double> f1;
+    f1.set_column_names("symbol", "price");
+    f1.push_back("MSFT", 400.0);
+    f1.push_back("AAPL", 180.0);
+    f1.push_back("MSFT", 402.0);
+    f1.push_back("IBM", 140.0);
+    f1.push_back("AAPL", 182.0);
+
+    SECTION("sort")
+    {
+        f1.sort(_0, _1);
+        auto it = f1.cbegin();
+        REQUIRE((it + 0)->at(_0) == "AAPL");
+        REQUIRE((it + 2)->at(_0) == "IBM");
+        REQUIRE((it + 4)->at(_0) == "MSFT");
+        REQUIRE((it + 4)->at(_1) == 402.0);
+    }
+
+    SECTION("groupby")
+    {
+        auto f2 = f1.groupby(_0).aggregate(agg::mean(_1), agg::count());
+        f2.sort(_0);
+        REQUIRE(f2.size() == 3);
+        auto it = f2.cbegin();
+        REQUIRE((it + 0)->at(_0) == "AAPL");
+        REQUIRE((it + 0)->at(_1) == 181.0);
+        REQUIRE((it + 0)->at(_2) == 2);
+        REQUIRE((it + 2)->at(_1) == 401.0);
+    }
+
+    SECTION("innerjoin")
+    {
+        frame<categorical, std::string> f2;
+        f2.push_back("AAPL", "NASDAQ");
+        f2.push_back("IBM", "NYSE");
+        auto f3 = innerjoin(f1, _0, f2, _0);
+        f3.sort(_0, _1);
+        REQUIRE(f3.size() == 3);
+        REQUIRE(f3.cbegin()->at(_3) == "NASDAQ");
+        REQUIRE((f3.cbegin() + 2)->at(_0) == "IBM");
+    }
+
+    SECTION("output")
+    {
+        std::stringstream ss;
+        ss << f1;
+        REQUIRE(ss.str().find("MSFT") != std::string::npos);
+    }
+}